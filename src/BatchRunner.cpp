@@ -0,0 +1,237 @@
+#include "BatchRunner.h"
+#include "Compressor.h"
+#include "ThreadPool.h"
+#include "QuadTree.h"
+#include "Image.h"
+#include "Trace.h"
+#include <algorithm>
+#include <condition_variable>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// Anggaran memori bersama antar worker. Gambar yang perkiraannya melebihi seluruh
+// anggaran tetap boleh berjalan, tetapi hanya sendirian.
+class MemoryBudget {
+private:
+    std::mutex mutex;
+    std::condition_variable released;
+    size_t capacity;
+    size_t used = 0;
+
+public:
+    explicit MemoryBudget(size_t capacityBytes) : capacity(capacityBytes) {}
+
+    void acquire(size_t bytes) {
+        std::unique_lock<std::mutex> lock(mutex);
+        released.wait(lock, [&] { return used == 0 || used + bytes <= capacity; });
+        used += bytes;
+    }
+
+    void release(size_t bytes) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            used -= bytes;
+        }
+        released.notify_all();
+    }
+};
+
+class BudgetReservation {
+private:
+    MemoryBudget& budget;
+    size_t bytes;
+
+public:
+    BudgetReservation(MemoryBudget& b, size_t n) : budget(b), bytes(n) { budget.acquire(bytes); }
+    ~BudgetReservation() { budget.release(bytes); }
+
+    BudgetReservation(const BudgetReservation&) = delete;
+    BudgetReservation& operator=(const BudgetReservation&) = delete;
+};
+
+} // namespace
+
+size_t BatchRunner::estimateMemoryBytes(int width, int height, int minBlockSize, size_t treeBudgetBytes,
+                                        SplitMode splitMode, LeafModel leafModel) {
+    const size_t pixelCount = static_cast<size_t>(width) * static_cast<size_t>(height);
+    // Buffer decode stb + gambar sumber + gambar rekonstruksi + hasil encode
+    const size_t imageBytes = pixelCount * (Image::NumChannels + 3 * sizeof(Pixel));
+    // Batas atas memori pohon: pohon penuh, atau batas memori pohon jika lebih kecil
+    size_t treeBytes = Quadtree::worstCaseTreeBytes(width, height, minBlockSize);
+    if (treeBudgetBytes > 0) {
+        treeBytes = std::min(treeBytes, treeBudgetBytes);
+    }
+    // Tabel jumlah tidak dibatasi anggaran pohon: ukurannya tetap per piksel
+    return imageBytes + treeBytes + Quadtree::regionStatsBytes(width, height, splitMode, leafModel);
+}
+
+std::vector<std::string> BatchRunner::collectInputs(const std::string& source) const {
+    std::vector<std::string> inputs;
+    fs::path sourcePath(source);
+
+    if (fs::is_directory(sourcePath)) {
+        std::string error;
+        for (const auto& entry : fs::directory_iterator(sourcePath)) {
+            if (entry.is_regular_file() && ioHandler.validateInputPath(entry.path().string(), false, error)) {
+                inputs.push_back(entry.path().string());
+            }
+        }
+        std::sort(inputs.begin(), inputs.end());
+    } else if (fs::is_regular_file(sourcePath)) {
+        // File daftar: satu path per baris, baris kosong dan komentar (#) dilewati
+        std::ifstream list(source);
+        std::string line;
+        while (std::getline(list, line)) {
+            line = IOHandler::trim(line);
+            if (!line.empty() && line[0] != '#') {
+                inputs.push_back(line);
+            }
+        }
+    } else {
+        throw std::invalid_argument("Input batch bukan direktori atau file daftar: " + source);
+    }
+    return inputs;
+}
+
+void BatchRunner::writeReport(const std::string& reportPath, const CompressionOptions& options,
+                              const std::vector<BatchItemResult>& results) const {
+    std::ofstream report(reportPath);
+    if (!report) {
+        throw std::runtime_error("Gagal menulis laporan batch: " + reportPath);
+    }
+
+    // Kolom statistik sama dengan keluaran --stats csv, ditambah status dan pesan error
+    report << "status,error," << IOHandler::statisticsCsvHeader() << "\n";
+    for (const BatchItemResult& item : results) {
+        CompressionOptions itemOptions = options;
+        itemOptions.inputPath = item.inputPath;
+        itemOptions.outputPath = item.outputPath;
+        itemOptions.gifPath.clear();
+        report << (item.success ? "ok" : "gagal") << ","
+               << IOHandler::csvString(item.error) << ","
+               << ioHandler.formatStatisticsCsvRow(itemOptions, item.stats) << "\n";
+    }
+}
+
+size_t BatchRunner::run(const CompressionOptions& options) const {
+    std::vector<std::string> inputs = collectInputs(options.batchInput);
+    if (inputs.empty()) {
+        throw std::invalid_argument("Tidak ada gambar yang didukung di: " + options.batchInput);
+    }
+
+    fs::create_directories(options.outputDir);
+    const std::string reportPath = options.reportPath.empty()
+        ? (fs::path(options.outputDir) / "batch_report.csv").string()
+        : options.reportPath;
+
+    // Nama output mengikuti nama input; nama kembar (dari direktori berbeda) diberi nomor urut
+    std::vector<BatchItemResult> results(inputs.size());
+    std::set<std::string> usedNames;
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        fs::path in(inputs[i]);
+        std::string name = in.filename().string();
+        if (!usedNames.insert(name).second) {
+            name = in.stem().string() + "_" + std::to_string(i) + in.extension().string();
+            usedNames.insert(name);
+        }
+        results[i].inputPath = inputs[i];
+        results[i].outputPath = (fs::path(options.outputDir) / name).string();
+    }
+
+    ioHandler.displayMessage("Mode batch: " + std::to_string(inputs.size()) + " gambar, anggaran memori " +
+                             std::to_string(options.memoryBudgetMB) + " MB.");
+
+    // Worker tidak mencetak pesan [INFO] agar keluaran beberapa gambar tidak saling bercampur
+    IOHandler workerIo;
+    workerIo.setQuiet(true);
+    const Compressor compressor(workerIo);
+    MemoryBudget budget(options.memoryBudgetMB * 1024 * 1024);
+    std::mutex progressMutex;
+    size_t finished = 0;
+
+    {
+        ThreadPool pool(options.threads);
+        std::vector<std::future<void>> pending;
+        pending.reserve(inputs.size());
+
+        for (size_t i = 0; i < inputs.size(); ++i) {
+            pending.push_back(pool.submit([&, i]() {
+                BatchItemResult& item = results[i];
+                Trace::Scope trace("batch", "image");
+                trace.arg("path", item.inputPath);
+                try {
+                    std::string error;
+                    if (!ioHandler.validateInputPath(item.inputPath, false, error)) {
+                        throw std::invalid_argument(error);
+                    }
+                    int w = 0, h = 0, channels = 0;
+                    if (!Image::readInfo(item.inputPath, w, h, channels)) {
+                        throw ImageError("Header gambar tidak dapat dibaca: " + item.inputPath);
+                    }
+
+                    CompressionOptions itemOptions = options;
+                    // Tanpa batas eksplisit, satu pohon tidak boleh melebihi seluruh anggaran batch
+                    if (itemOptions.maxTreeMemoryMB == 0) {
+                        itemOptions.maxTreeMemoryMB = options.memoryBudgetMB;
+                    }
+                    BudgetReservation reservation(budget, estimateMemoryBytes(w, h, options.minBlockSize,
+                                                                              itemOptions.maxTreeMemoryMB * 1024 * 1024,
+                                                                              options.splitMode, options.leafModel));
+
+                    itemOptions.inputPath = item.inputPath;
+                    itemOptions.outputPath = item.outputPath;
+                    itemOptions.gifPath.clear();
+                    // Paralelisme sudah di tingkat gambar; pencarian target per gambar berjalan berurutan
+                    itemOptions.threads = 1;
+
+                    Image source = compressor.loadInput(item.inputPath, item.stats);
+                    compressor.compress(source, itemOptions, item.stats);
+                    item.success = true;
+                } catch (const std::exception& e) {
+                    item.error = e.what();
+                }
+
+                std::lock_guard<std::mutex> lock(progressMutex);
+                ++finished;
+                std::string status = item.success
+                    ? "selesai (" + std::to_string(item.stats.inputBytes) + " -> " + std::to_string(item.stats.outputBytes) + " bytes)"
+                    : "gagal: " + item.error;
+                ioHandler.displayMessage("[" + std::to_string(finished) + "/" + std::to_string(results.size()) + "] " +
+                                         item.inputPath + " " + status);
+            }));
+        }
+
+        for (std::future<void>& f : pending) {
+            f.get();
+        }
+    }
+
+    writeReport(reportPath, options, results);
+
+    size_t failures = 0;
+    uintmax_t totalIn = 0, totalOut = 0;
+    for (const BatchItemResult& item : results) {
+        if (!item.success) {
+            ++failures;
+            ioHandler.displayError("Gagal mengompresi " + item.inputPath + ": " + item.error);
+            continue;
+        }
+        totalIn += item.stats.inputBytes;
+        totalOut += item.stats.outputBytes;
+    }
+
+    ioHandler.displayMessage("Batch selesai: " + std::to_string(results.size() - failures) + " berhasil, " +
+                             std::to_string(failures) + " gagal. Total " + std::to_string(totalIn) + " -> " +
+                             std::to_string(totalOut) + " bytes.");
+    ioHandler.displayMessage("Laporan batch disimpan ke: " + reportPath);
+    return failures;
+}
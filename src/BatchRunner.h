@@ -0,0 +1,43 @@
+#ifndef BATCHRUNNER_H
+#define BATCHRUNNER_H
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include "IOHandler.h"
+#include "CompressionOptions.h"
+
+// Hasil kompresi satu gambar dalam mode batch
+struct BatchItemResult {
+    std::string inputPath;
+    std::string outputPath;
+    bool success = false;
+    std::string error;
+    CompressionResult stats;
+};
+
+// Mengompresi banyak gambar dengan pengaturan yang sama di dalam satu proses.
+// Gambar dikerjakan paralel oleh thread pool berukuran tetap; gambar hanya mulai
+// diproses jika perkiraan memorinya masih muat di dalam anggaran memori.
+class BatchRunner {
+private:
+    const IOHandler& ioHandler;
+
+    std::vector<std::string> collectInputs(const std::string& source) const;
+    void writeReport(const std::string& reportPath, const CompressionOptions& options,
+                     const std::vector<BatchItemResult>& results) const;
+
+public:
+    explicit BatchRunner(const IOHandler& io) : ioHandler(io) {}
+
+    // Perkiraan kasar puncak memori saat mengompresi gambar w x h (treeBudgetBytes = 0: tanpa batas pohon),
+    // termasuk tabel RegionStats jika splitMode/leafModel memakainya
+    static size_t estimateMemoryBytes(int width, int height, int minBlockSize, size_t treeBudgetBytes = 0,
+                                      SplitMode splitMode = SplitMode::QUAD, LeafModel leafModel = LeafModel::FLAT);
+
+    // Memproses semua gambar di options.batchInput ke options.outputDir, lalu menulis satu laporan.
+    // Mengembalikan jumlah gambar yang gagal.
+    size_t run(const CompressionOptions& options) const;
+};
+
+#endif // BATCHRUNNER_H
@@ -0,0 +1,102 @@
+#ifndef COMPRESSIONOPTIONS_H
+#define COMPRESSIONOPTIONS_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "QuadTree.h"
+
+// Format keluaran statistik: teks untuk manusia, atau JSON/CSV untuk dashboard dan script
+enum class StatsFormat {
+    TEXT,
+    JSON,
+    CSV
+};
+
+// Penggabungan leaf setelah pohon dibentuk
+enum class MergeMode {
+    NONE,
+    SIBLINGS, // anak-anak leaf yang warnanya mirip digabung kembali ke induknya
+    REGIONS   // SIBLINGS, lalu leaf bertetangga lintas induk digabung menjadi persegi panjang untuk output
+};
+
+// Semua parameter satu kali kompresi, diisi dari prompt interaktif maupun argumen command line
+struct CompressionOptions {
+    std::string inputPath;
+    std::string outputPath;
+    std::string gifPath;                 // kosong = tidak membuat GIF
+    ErrorMetric metric = ErrorMetric::VARIANCE;
+    float threshold = 0.0f;
+    int minBlockSize = 1;
+    float targetCompressionRatio = 0.0f; // 0 = mode target nonaktif
+    int jpgQuality = 85;
+    unsigned threads = 0;                // thread GIF dan percobaan paralel mode target (0 = semua core)
+    StatsFormat statsFormat = StatsFormat::TEXT;
+    std::string tracePath;               // kosong = tanpa trace; selain itu file Chrome trace JSON
+    size_t maxTreeMemoryMB = 0;          // batas memori simpul pohon per gambar (0 = tanpa batas)
+    BuildMode buildMode = BuildMode::DEPTH_FIRST;
+    size_t maxLeaves = 0;                // batas leaf untuk BEST_FIRST (0 = hanya threshold)
+    SplitMode splitMode = SplitMode::QUAD;
+    MergeMode mergeMode = MergeMode::NONE;
+    int mergeTolerance = 0;              // selisih warna per channel yang masih digabung (0 = identik)
+    LeafModel leafModel = LeafModel::FLAT;
+    double lambda = 0.0;                 // lambda RATE_DISTORTION (distorsi per bit) jika mode target nonaktif
+    double minPsnr = 0.0;                // mode target kualitas: PSNR minimum dalam dB (0 = nonaktif)
+    double minSsim = 0.0;                // mode target kualitas: SSIM minimum 0..1 (0 = nonaktif)
+    std::string sweepPath;               // kosong = kompresi biasa; selain itu CSV kurva rate/kualitas semua threshold
+    size_t sweepEncodeCount = 0;         // titik sweep yang di-encode sungguhan untuk kalibrasi ukuran
+
+    // Mode batch: direktori atau file daftar (satu path per baris) sebagai pengganti inputPath
+    std::string batchInput;
+    std::string outputDir;
+    std::string reportPath;              // kosong = <outputDir>/batch_report.csv
+    size_t memoryBudgetMB = 1024;        // perkiraan memori maksimum untuk gambar yang diproses bersamaan
+
+    // Mode server: path Unix domain socket, dan batas permintaan tertunda per koneksi (0 = 2 x thread)
+    std::string serveSocket;
+    size_t maxPending = 0;
+};
+
+// Durasi tiap tahap kompresi dalam milidetik
+struct PhaseTimings {
+    double loadMs = 0.0;         // baca file + decode
+    double searchMs = 0.0;       // pencarian threshold (mode target)
+    double buildMs = 0.0;        // pembentukan pohon final
+    double reconstructMs = 0.0;  // rekonstruksi gambar dari pohon final
+    double encodeMs = 0.0;       // encode (dan tulis) gambar output
+    double gifMs = 0.0;
+
+    double total() const { return loadMs + searchMs + buildMs + reconstructMs + encodeMs + gifMs; }
+};
+
+// Hasil satu kali kompresi
+struct CompressionResult {
+    float finalThreshold = 0.0f;
+    uintmax_t inputBytes = 0;
+    uintmax_t outputBytes = 0;
+    int imageWidth = 0;
+    int imageHeight = 0;
+    int treeDepth = -1;
+    size_t nodeCount = 0;
+    size_t leafCount = 0;
+    std::vector<size_t> leafDepthHistogram;  // indeks 0 = kedalaman 1 (root)
+    int searchIterations = 0;
+    int searchEncodes = 0;                   // encode sebenarnya selama pencarian threshold
+    int searchRounds = 0;                    // putaran pencarian; tiap putaran mencoba beberapa threshold paralel
+    double execTimeMs = 0.0;                 // semua tahap setelah gambar dimuat
+    PhaseTimings phases;
+    size_t peakRssKB = 0;                    // 0 jika tidak tersedia di platform ini
+    size_t treeBytes = 0;                    // memori pohon final (simpul + tabel RegionStats)
+    int effectiveMinBlockSize = 0;           // minBlockSize yang dipakai setelah pembatasan memori
+    size_t finalMaxLeaves = 0;               // batas leaf hasil pencarian target untuk BEST_FIRST (0 = tidak dicari)
+    double targetRateBits = 0.0;             // target rate RATE_DISTORTION dari ukuran target (0 = pakai lambda)
+    double finalLambda = 0.0;                // lambda RATE_DISTORTION yang dipakai pohon final
+    double rateBits = 0.0;                   // estimasi rate pohon final RATE_DISTORTION
+    double psnr = 0.0;                       // kualitas pohon final terhadap sumber, dari SSE leaf
+    double ssim = 0.0;
+    bool qualityFloorMet = true;             // false jika --min-psnr/--min-ssim tidak tercapai oleh pohon final
+    size_t regionCount = 0;                  // persegi panjang output pada --merge regions (0 = tidak dipakai)
+};
+
+#endif // COMPRESSIONOPTIONS_H
@@ -0,0 +1,461 @@
+#include "CompressionServer.h"
+
+#ifdef _WIN32
+
+#include <stdexcept>
+
+void CompressionServer::run(const std::string&) {
+    throw std::runtime_error("Mode server membutuhkan Unix domain socket dan tidak didukung di Windows.");
+}
+
+#else
+
+#include "Compressor.h"
+#include "ThreadPool.h"
+#include "Image.h"
+#include "Trace.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include <csignal>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr uint32_t MaxHeaderBytes = 64 * 1024;
+constexpr uint32_t MaxPayloadBytes = 512u * 1024 * 1024;
+
+std::atomic<bool> stopRequested{false};
+
+extern "C" void handleStopSignal(int) {
+    stopRequested.store(true);
+}
+
+struct Request {
+    std::string header;
+    std::vector<unsigned char> payload;
+};
+
+struct Response {
+    uint32_t status = 0;
+    std::string meta;
+    std::vector<unsigned char> data;
+};
+
+// Antrian berkapasitas tetap; push memblokir saat penuh sehingga pembaca koneksi
+// berhenti membaca socket dan klien ikut tertahan (back-pressure)
+template <typename T>
+class BoundedQueue {
+private:
+    std::mutex mutex;
+    std::condition_variable notFull;
+    std::condition_variable notEmpty;
+    std::deque<T> items;
+    size_t capacity;
+    bool closed = false;
+
+public:
+    explicit BoundedQueue(size_t cap) : capacity(std::max<size_t>(1, cap)) {}
+
+    bool push(T item) {
+        std::unique_lock<std::mutex> lock(mutex);
+        notFull.wait(lock, [&] { return closed || items.size() < capacity; });
+        if (closed) {
+            return false;
+        }
+        items.push_back(std::move(item));
+        notEmpty.notify_one();
+        return true;
+    }
+
+    // Mengembalikan false jika antrian sudah ditutup dan kosong
+    bool pop(T& out) {
+        std::unique_lock<std::mutex> lock(mutex);
+        notEmpty.wait(lock, [&] { return closed || !items.empty(); });
+        if (items.empty()) {
+            return false;
+        }
+        out = std::move(items.front());
+        items.pop_front();
+        notFull.notify_one();
+        return true;
+    }
+
+    void close() {
+        std::lock_guard<std::mutex> lock(mutex);
+        closed = true;
+        notFull.notify_all();
+        notEmpty.notify_all();
+    }
+};
+
+bool readFully(int fd, void* buffer, size_t size) {
+    auto* out = static_cast<unsigned char*>(buffer);
+    while (size > 0) {
+        ssize_t n = ::read(fd, out, size);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        out += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+bool writeFully(int fd, const void* buffer, size_t size) {
+    auto* in = static_cast<const unsigned char*>(buffer);
+    while (size > 0) {
+        ssize_t n = ::write(fd, in, size);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        in += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+bool readU32(int fd, uint32_t& value) {
+    unsigned char bytes[4];
+    if (!readFully(fd, bytes, 4)) {
+        return false;
+    }
+    value = (uint32_t(bytes[0]) << 24) | (uint32_t(bytes[1]) << 16) | (uint32_t(bytes[2]) << 8) | uint32_t(bytes[3]);
+    return true;
+}
+
+void appendU32(std::vector<unsigned char>& out, uint32_t value) {
+    out.push_back(static_cast<unsigned char>(value >> 24));
+    out.push_back(static_cast<unsigned char>(value >> 16));
+    out.push_back(static_cast<unsigned char>(value >> 8));
+    out.push_back(static_cast<unsigned char>(value));
+}
+
+// Membaca satu frame permintaan. Mengembalikan false saat koneksi ditutup;
+// frame yang melanggar batas ukuran dilempar sebagai std::invalid_argument.
+bool readRequest(int fd, Request& request) {
+    uint32_t headerSize = 0, payloadSize = 0;
+    if (!readU32(fd, headerSize)) {
+        return false;
+    }
+    if (headerSize > MaxHeaderBytes) {
+        throw std::invalid_argument("Header permintaan terlalu besar: " + std::to_string(headerSize) + " bytes");
+    }
+    request.header.resize(headerSize);
+    if (!readFully(fd, &request.header[0], headerSize) || !readU32(fd, payloadSize)) {
+        return false;
+    }
+    if (payloadSize > MaxPayloadBytes) {
+        throw std::invalid_argument("Payload permintaan terlalu besar: " + std::to_string(payloadSize) + " bytes");
+    }
+    request.payload.resize(payloadSize);
+    return readFully(fd, request.payload.data(), payloadSize);
+}
+
+bool writeResponse(int fd, const Response& response) {
+    // Header respons dan meta dikirim dalam satu write, lalu data gambar apa adanya
+    std::vector<unsigned char> head;
+    head.reserve(12 + response.meta.size());
+    appendU32(head, response.status);
+    appendU32(head, static_cast<uint32_t>(response.meta.size()));
+    head.insert(head.end(), response.meta.begin(), response.meta.end());
+    appendU32(head, static_cast<uint32_t>(response.data.size()));
+    return writeFully(fd, head.data(), head.size()) &&
+           writeFully(fd, response.data.data(), response.data.size());
+}
+
+struct ServerContext {
+    const IOHandler& ioHandler;
+    const Compressor& compressor;
+    const CompressionOptions& defaults;
+};
+
+Response handleRequest(const ServerContext& ctx, const Request& request) {
+    Response response;
+    try {
+        CompressionOptions options = ctx.defaults;
+        options.threads = 1; // permintaan sudah diproses paralel oleh pool server
+        std::string path, format;
+        bool thresholdGiven = false;
+
+        std::istringstream header(request.header);
+        std::string line;
+        while (std::getline(header, line)) {
+            line = IOHandler::trim(line);
+            if (line.empty()) {
+                continue;
+            }
+            size_t eq = line.find('=');
+            if (eq == std::string::npos) {
+                throw std::invalid_argument("Baris header tidak valid: " + line);
+            }
+            const std::string key = IOHandler::toLower(IOHandler::trim(line.substr(0, eq)));
+            const std::string value = IOHandler::trim(line.substr(eq + 1));
+
+            if (key == "path") {
+                path = value;
+            } else if (key == "format") {
+                format = IOHandler::toLower(value);
+                if (!format.empty() && format[0] == '.') {
+                    format.erase(0, 1);
+                }
+            } else if (key == "metric") {
+                options.metric = IOHandler::parseMetric(value);
+            } else if (key == "threshold") {
+                options.threshold = IOHandler::parseFloat(key, value);
+                thresholdGiven = true;
+            } else if (key == "min-block") {
+                options.minBlockSize = IOHandler::parseInt(key, value);
+            } else if (key == "target") {
+                options.targetCompressionRatio = IOHandler::parseFloat(key, value);
+            } else if (key == "build") {
+                options.buildMode = IOHandler::parseBuildMode(value);
+            } else if (key == "split") {
+                options.splitMode = IOHandler::parseSplitMode(value);
+            } else if (key == "merge") {
+                options.mergeMode = IOHandler::parseMergeMode(value);
+            } else if (key == "leaf-model") {
+                options.leafModel = IOHandler::parseLeafModel(value);
+            } else if (key == "merge-tolerance") {
+                options.mergeTolerance = IOHandler::parseInt(key, value);
+                if (options.mergeTolerance < 0 || options.mergeTolerance > 255) {
+                    throw std::invalid_argument("Toleransi penggabungan harus di antara 0 dan 255.");
+                }
+            } else if (key == "max-leaves") {
+                IOHandler::applyMaxLeaves(IOHandler::parseInt(key, value), options);
+            } else if (key == "lambda") {
+                options.lambda = IOHandler::parseFloat(key, value);
+                if (options.lambda < 0.0) {
+                    throw std::invalid_argument("Lambda tidak boleh negatif.");
+                }
+            } else if (key == "min-psnr") {
+                IOHandler::applyMinPsnr(IOHandler::parseFloat(key, value), options);
+            } else if (key == "min-ssim") {
+                IOHandler::applyMinSsim(IOHandler::parseFloat(key, value), options);
+            } else if (key == "quality") {
+                options.jpgQuality = IOHandler::parseInt(key, value);
+            } else {
+                throw std::invalid_argument("Kunci header tidak dikenal: " + key);
+            }
+        }
+
+        std::string error;
+        if ((thresholdGiven && !ctx.ioHandler.validateThreshold(options.metric, options.threshold, error)) ||
+            !ctx.ioHandler.validateMinBlockSize(options.minBlockSize, error) ||
+            !ctx.ioHandler.validateTargetCompression(options.targetCompressionRatio, error)) {
+            throw std::invalid_argument(error);
+        }
+
+        if (format.empty()) {
+            std::string ext = path.empty() ? "" : fs::path(path).extension().string();
+            format = ext.size() > 1 ? IOHandler::toLower(ext.substr(1)) : "png";
+        }
+        if (format != "png" && format != "jpg" && format != "jpeg" && format != "bmp" && format != "tga") {
+            throw std::invalid_argument("Format output tidak didukung: " + format);
+        }
+
+        Trace::Scope trace("server", "request");
+        trace.arg("format", format);
+        Image source;
+        CompressionResult result;
+        if (!request.payload.empty()) {
+            auto decodeStart = std::chrono::steady_clock::now();
+            source = Image::loadFromMemory(request.payload.data(), request.payload.size());
+            result.phases.loadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - decodeStart).count();
+            result.inputBytes = request.payload.size();
+        } else if (!path.empty()) {
+            if (!ctx.ioHandler.validateInputPath(path, false, error)) {
+                throw std::invalid_argument(error);
+            }
+            options.inputPath = path;
+            source = ctx.compressor.loadInput(path, result);
+        } else {
+            throw std::invalid_argument("Permintaan harus berisi byte gambar atau path.");
+        }
+
+        ctx.compressor.compressToMemory(source, options, "." + format, response.data, result);
+        response.meta = ctx.ioHandler.formatStatisticsJson(options, result);
+    } catch (const std::exception& e) {
+        response.status = 1;
+        response.meta = e.what();
+        response.data.clear();
+    }
+    return response;
+}
+
+Response errorResponse(const std::string& message) {
+    Response response;
+    response.status = 1;
+    response.meta = message;
+    return response;
+}
+
+struct Connection {
+    int fd = -1;
+    std::thread thread;
+    std::atomic<bool> finished{false};
+};
+
+// Satu koneksi: thread ini membaca permintaan dan men-submit-nya ke pool, sementara
+// thread penulis mengirim respons sesuai urutan permintaan
+void serveConnection(Connection& connection, ThreadPool& pool, const ServerContext& ctx, size_t maxPending) {
+    const int fd = connection.fd;
+    BoundedQueue<std::future<Response>> pending(maxPending);
+
+    std::thread writer([&]() {
+        bool writable = true;
+        std::future<Response> next;
+        while (pending.pop(next)) {
+            Response response = next.get();
+            if (writable && !writeResponse(fd, response)) {
+                // Klien sudah tidak membaca; hentikan pembaca dan buang sisa respons
+                writable = false;
+                ::shutdown(fd, SHUT_RD);
+                pending.close();
+            }
+        }
+    });
+
+    while (true) {
+        auto request = std::make_shared<Request>();
+        try {
+            if (!readRequest(fd, *request)) {
+                break;
+            }
+        } catch (const std::invalid_argument& e) {
+            // Frame rusak: kirim error lalu tutup koneksi karena posisi baca tidak lagi sinkron
+            std::promise<Response> failed;
+            failed.set_value(errorResponse(e.what()));
+            pending.push(failed.get_future());
+            break;
+        }
+
+        std::future<Response> result = pool.submit([&ctx, request]() {
+            return handleRequest(ctx, *request);
+        });
+        if (!pending.push(std::move(result))) {
+            break;
+        }
+    }
+
+    pending.close();
+    writer.join();
+    // fd ditutup oleh thread utama setelah join, agar shutdown saat server berhenti tidak salah sasaran
+    connection.finished.store(true);
+}
+
+} // namespace
+
+void CompressionServer::run(const std::string& socketPath) {
+    sockaddr_un address{};
+    if (socketPath.empty() || socketPath.size() >= sizeof(address.sun_path)) {
+        throw std::runtime_error("Path socket kosong atau terlalu panjang: " + socketPath);
+    }
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+
+    // Socket sisa proses sebelumnya dihapus, file lain tidak disentuh
+    std::error_code ec;
+    if (fs::is_socket(socketPath, ec)) {
+        fs::remove(socketPath, ec);
+    }
+
+    int listenFd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenFd < 0) {
+        throw std::runtime_error("Gagal membuat socket: " + std::string(std::strerror(errno)));
+    }
+    if (::bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        ::listen(listenFd, SOMAXCONN) != 0) {
+        std::string reason = std::strerror(errno);
+        ::close(listenFd);
+        throw std::runtime_error("Gagal membuka socket " + socketPath + ": " + reason);
+    }
+
+    stopRequested.store(false);
+    std::signal(SIGINT, handleStopSignal);
+    std::signal(SIGTERM, handleStopSignal);
+    // Klien yang menutup koneksi lebih dulu tidak boleh mematikan server
+    std::signal(SIGPIPE, SIG_IGN);
+
+    // Pool, kamus LZW per thread, dan parameter default dibuat sekali untuk seluruh umur server
+    ThreadPool pool(defaults.threads);
+    const size_t maxPending = defaults.maxPending > 0 ? defaults.maxPending : pool.size() * 2;
+    IOHandler workerIo;
+    workerIo.setQuiet(true);
+    const Compressor compressor(workerIo);
+    const ServerContext ctx{workerIo, compressor, defaults};
+
+    ioHandler.displayMessage("Server mendengarkan di " + socketPath + " (" + std::to_string(pool.size()) +
+                             " thread, maks " + std::to_string(maxPending) + " permintaan tertunda per koneksi).");
+
+    std::list<std::unique_ptr<Connection>> connections;
+    while (!stopRequested.load()) {
+        // Koneksi yang sudah selesai dibereskan agar daemon tidak menumpuk thread
+        for (auto it = connections.begin(); it != connections.end();) {
+            if ((*it)->finished.load()) {
+                (*it)->thread.join();
+                ::close((*it)->fd);
+                it = connections.erase(it);
+            } else {
+                ++it;
+            }
+        }
+
+        pollfd listening{listenFd, POLLIN, 0};
+        int ready = ::poll(&listening, 1, 200);
+        if (ready <= 0) {
+            continue;
+        }
+        int clientFd = ::accept(listenFd, nullptr, nullptr);
+        if (clientFd < 0) {
+            continue;
+        }
+
+        auto connection = std::make_unique<Connection>();
+        connection->fd = clientFd;
+        Connection& ref = *connection;
+        connection->thread = std::thread([&ref, &pool, &ctx, maxPending]() {
+            serveConnection(ref, pool, ctx, maxPending);
+        });
+        connections.push_back(std::move(connection));
+    }
+
+    ioHandler.displayMessage("Server berhenti, menyelesaikan permintaan yang tersisa...");
+    ::close(listenFd);
+    for (auto& connection : connections) {
+        // Berhenti membaca permintaan baru; respons yang masih dikerjakan tetap dikirim
+        ::shutdown(connection->fd, SHUT_RD);
+        connection->thread.join();
+        ::close(connection->fd);
+    }
+    fs::remove(socketPath, ec);
+
+    std::signal(SIGINT, SIG_DFL);
+    std::signal(SIGTERM, SIG_DFL);
+}
+
+#endif
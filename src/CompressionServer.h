@@ -0,0 +1,36 @@
+#ifndef COMPRESSIONSERVER_H
+#define COMPRESSIONSERVER_H
+
+#include <string>
+#include <cstddef>
+#include "IOHandler.h"
+#include "CompressionOptions.h"
+
+// Mode server: proses berjalan terus dan menerima permintaan kompresi lewat Unix domain socket.
+//
+// Setiap permintaan dan respons adalah frame biner (semua panjang uint32 big-endian):
+//   permintaan: [panjang header][header][panjang payload][payload]
+//     header berisi baris "kunci=nilai": path, format (png/jpg/bmp/tga), metric, threshold,
+//     min-block, target, quality. Payload berisi byte gambar; jika kosong, gambar dibaca dari path.
+//   respons:    [status][panjang meta][meta][panjang data][data]
+//     status 0 = berhasil, meta berisi statistik JSON dan data berisi gambar hasil kompresi;
+//     status selain 0 = gagal, meta berisi pesan error dan data kosong.
+//
+// Klien boleh mengirim beberapa permintaan tanpa menunggu respons (pipelining); respons
+// dikirim sesuai urutan permintaan. Jika sudah ada maxPending permintaan yang belum dijawab
+// pada satu koneksi, server berhenti membaca dari koneksi tersebut (back-pressure).
+class CompressionServer {
+private:
+    const IOHandler& ioHandler;
+    CompressionOptions defaults;
+
+public:
+    CompressionServer(const IOHandler& io, const CompressionOptions& defaultOptions)
+        : ioHandler(io), defaults(defaultOptions) {}
+
+    // Memblokir sampai menerima SIGINT atau SIGTERM. Melempar std::runtime_error jika socket
+    // tidak dapat dibuat atau platform tidak mendukung Unix domain socket.
+    void run(const std::string& socketPath);
+};
+
+#endif // COMPRESSIONSERVER_H
@@ -0,0 +1,735 @@
+#include "Compressor.h"
+#include "QuadTree.h"
+#include "MakeGif.h"
+#include "MakeFrame.h"
+#include <chrono>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+#include <numeric>
+#include <optional>
+#include <map>
+#include <memory>
+#include "ResourceUsage.h"
+#include "SizeEstimator.h"
+#include "ThresholdSearch.h"
+#include "ThresholdSweep.h"
+#include "RegionMerge.h"
+#include "ThreadPool.h"
+#include "Trace.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double elapsedMs(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// Statistik pohon final yang sama untuk output file maupun memori. extraSquaredError =
+// error tambahan gambar output di luar leaf pohon (penggabungan wilayah).
+void recordTreeStats(const Quadtree& tree, CompressionResult& result, double extraSquaredError = 0.0) {
+    result.treeDepth = tree.getDepth();
+    result.nodeCount = tree.getNodeCount();
+    result.leafDepthHistogram = tree.getLeafDepthHistogram();
+    result.leafCount = std::accumulate(result.leafDepthHistogram.begin(), result.leafDepthHistogram.end(), size_t{0});
+    result.treeBytes = tree.getMemoryUsage();
+    result.effectiveMinBlockSize = tree.getEffectiveMinBlockSize();
+    result.finalLambda = tree.getLambda();
+    result.rateBits = tree.getRateBits();
+    result.psnr = Quadtree::psnrFromSquaredError(tree.getSquaredError() + extraSquaredError,
+                                                 static_cast<size_t>(result.imageWidth) * result.imageHeight);
+    result.ssim = tree.getSSIM();
+}
+
+QuadtreeOptions treeOptionsFor(const CompressionOptions& options) {
+    QuadtreeOptions treeOptions;
+    treeOptions.memoryBudgetBytes = options.maxTreeMemoryMB * 1024 * 1024;
+    treeOptions.buildMode = options.buildMode;
+    treeOptions.maxLeaves = options.maxLeaves;
+    treeOptions.lambda = options.lambda;
+    treeOptions.splitMode = options.splitMode;
+    treeOptions.mergeTolerance = options.mergeMode != MergeMode::NONE ? options.mergeTolerance : -1;
+    treeOptions.leafModel = options.leafModel;
+    return treeOptions;
+}
+
+// Pohon final memakai batas leaf hasil pencarian target jika ada
+QuadtreeOptions finalTreeOptions(const CompressionOptions& options, const CompressionResult& result) {
+    QuadtreeOptions treeOptions = treeOptionsFor(options);
+    if (result.finalMaxLeaves > 0) {
+        treeOptions.maxLeaves = result.finalMaxLeaves;
+    }
+    treeOptions.targetRateBits = result.targetRateBits;
+    return treeOptions;
+}
+
+// Gambar hasil dari pohon final, atau dari wilayah gabungan jika --merge regions
+Image reconstructFinal(const Quadtree& tree, const CompressionOptions& options, CompressionResult& result,
+                       double& addedSquaredError) {
+    addedSquaredError = 0.0;
+    if (options.mergeMode != MergeMode::REGIONS) {
+        return tree.reconstructImage();
+    }
+    const std::vector<LeafRegion> regions = RegionMerge::fromTree(tree, options.mergeTolerance, &addedSquaredError);
+    result.regionCount = regions.size();
+    return RegionMerge::reconstruct(result.imageWidth, result.imageHeight, regions);
+}
+
+// Kualitas gambar output pohon, termasuk error tambahan penggabungan wilayah pada --merge regions
+void measureOutputQuality(const Quadtree& tree, const CompressionOptions& options, size_t pixelCount,
+                          double& psnr, double& ssim) {
+    double addedSquaredError = 0.0;
+    if (options.mergeMode == MergeMode::REGIONS) {
+        RegionMerge::fromTree(tree, options.mergeTolerance, &addedSquaredError);
+    }
+    psnr = Quadtree::psnrFromSquaredError(tree.getSquaredError() + addedSquaredError, pixelCount);
+    ssim = tree.getSSIM();
+}
+
+// PSNR kurva sweep dan PSNR pohon final menjumlahkan SSE leaf dengan urutan berbeda, jadi
+// selisih pembulatan sekecil ini tidak dianggap gagal memenuhi batas
+bool meetsQualityFloor(double psnr, double ssim, const CompressionOptions& options) {
+    const double slack = 1e-9;
+    return psnr >= options.minPsnr - slack && ssim >= options.minSsim - slack;
+}
+
+bool qualityTargetActive(const CompressionOptions& options) {
+    return options.minPsnr > 0.0 || options.minSsim > 0.0;
+}
+
+} // namespace
+
+Image Compressor::loadInput(const std::string& inputPath, CompressionResult& stats) const {
+    Trace::Scope trace("io", "load");
+    trace.arg("path", inputPath);
+    auto loadStart = Clock::now();
+    Image image;
+    try {
+        image = Image::loadFromFile(inputPath);
+    } catch (const ImageError& e) {
+        throw ImageError("Gagal memuat gambar input: " + std::string(e.what()));
+    }
+    stats.phases.loadMs = elapsedMs(loadStart);
+    ioHandler.displayMessage("File Berhasil di Load!!");
+
+    stats.inputBytes = 0;
+    try {
+        stats.inputBytes = fs::file_size(inputPath);
+        if (stats.inputBytes == 0) {
+            ioHandler.displayError("Warning: Ukuran file input adalah 0.");
+        }
+    } catch (const fs::filesystem_error& e) {
+        ioHandler.displayError("Gagal mendapatkan ukuran file input: " + std::string(e.what()));
+    }
+
+    if (image.isEmpty()) {
+        throw ImageError("Gambar input gagal dimuat atau kosong.");
+    }
+    return image;
+}
+
+float Compressor::searchThresholdForTarget(const Image& sourceImage, uintmax_t inputBytes,
+                                           const CompressionOptions& options, const std::string& extension,
+                                           CompressionResult& result) const {
+    const double inputSizeKB = static_cast<double>(inputBytes) / 1024.0;
+    double targetSizeRatio = 1.0 - options.targetCompressionRatio;
+    uintmax_t targetSizeBytes = static_cast<uintmax_t>(static_cast<double>(inputBytes) * targetSizeRatio);
+    ioHandler.displayMessage("Ukuran file asli: " + std::to_string(inputBytes) + " bytes (" + std::to_string(inputSizeKB) + " KB)");
+    ioHandler.displayMessage("Target ukuran file: " + std::to_string(targetSizeBytes) + " bytes (Format: " + extension + ")");
+
+    // Rentang pencarian mengikuti rentang threshold metrik (misalnya entropi 0..8, SSIM 0..1)
+    std::string metricName;
+    float minTh = 0.0f;
+    float maxTh = 0.0f;
+    IOHandler::getThresholdRange(options.metric, metricName, minTh, maxTh);
+    const int maxIterations = 40;
+    const int maxEncodes = 3;
+    const float toleranceRatio = 0.05f;
+    const double toleranceBytes = static_cast<double>(targetSizeBytes) * toleranceRatio;
+    float bestTh = options.threshold;
+    long long minDiff = std::numeric_limits<long long>::max();
+
+    // Setiap iterasi hanya membangun pohon dan memperkirakan ukurannya; encode sebenarnya
+    // dilakukan untuk kandidat akhir saja, lalu perkiraan dikalibrasi dengan hasilnya.
+    // Statistik pohon disimpan per threshold sehingga setelah kalibrasi semua sampel lama
+    // dinilai ulang tanpa membangun pohon lagi.
+    SizeEstimator estimator(extension, options.jpgQuality);
+    std::map<double, std::pair<size_t, TreeSizeFeatures>> probes;
+    std::unique_ptr<Quadtree> lastQt;
+    double lastQtThreshold = -1.0;
+
+    // Beberapa threshold dicoba bersamaan per putaran; semua pohon membaca sourceImage yang sama.
+    // Setiap percobaan membangun pohon utuh, jadi percobaan melebihi jumlah core hanya menambah
+    // memori tanpa mempercepat. Dengan --max-tree-memory, semua pohon yang hidup bersamaan
+    // (percobaan satu putaran ditambah pohon terdekat yang disimpan untuk encode) harus muat di
+    // batas tersebut; jika hanya satu pohon yang muat, percobaan berjalan satu per satu dan pohon
+    // terdekat tidak disimpan.
+    unsigned probeCount = std::min(options.threads == 0 ? ThreadPool::defaultThreadCount() : options.threads,
+                                   ThreadPool::defaultThreadCount());
+    bool keepClosest = true;
+    const size_t treeBudgetBytes = options.maxTreeMemoryMB * 1024 * 1024;
+    if (treeBudgetBytes > 0) {
+        const size_t bytesPerTree = std::min(treeBudgetBytes, Quadtree::worstCaseTreeBytes(sourceImage.getWidth(), sourceImage.getHeight(),
+                                                                                            options.minBlockSize));
+        const size_t treesThatFit = treeBudgetBytes / std::max<size_t>(bytesPerTree, 1);
+        keepClosest = treesThatFit >= 2;
+        probeCount = keepClosest ? static_cast<unsigned>(std::min<size_t>(probeCount, treesThatFit - 1)) : 1;
+    }
+    struct Probe {
+        std::unique_ptr<Quadtree> tree;
+        TreeSizeFeatures features;
+    };
+    auto buildProbe = [&](double threshold) {
+        Trace::Scope trace("search", "probe");
+        trace.arg("threshold", threshold);
+        Probe probe;
+        probe.tree = std::make_unique<Quadtree>(sourceImage, options.metric, threshold, options.minBlockSize, treeOptionsFor(options));
+        probe.features = TreeSizeFeatures::fromTree(*probe.tree);
+        return probe;
+    };
+    // Dideklarasikan setelah buildProbe sehingga worker sudah selesai sebelum lambda itu hilang
+    std::optional<ThreadPool> pool;
+    if (probeCount > 1) {
+        pool.emplace(probeCount);
+    }
+    ioHandler.displayMessage("Memulai pencarian threshold " + metricName + " (maks " + std::to_string(maxIterations) + " putaran x " + std::to_string(probeCount) + " percobaan, " +
+                             std::to_string(maxEncodes) + " encode) rentang awal: [" + std::to_string(minTh) + "..." + std::to_string(maxTh) + "]");
+
+    for (int round = 0; round < maxEncodes; ++round) {
+        ThresholdSearch search(minTh, maxTh, static_cast<double>(targetSizeBytes), toleranceBytes);
+        for (const auto& [threshold, probe] : probes) {
+            if (threshold >= minTh && threshold <= maxTh) {
+                search.record({threshold, probe.first, estimator.estimate(probe.second)});
+            }
+        }
+
+        try {
+            while (result.searchRounds < maxIterations && !search.converged()) {
+                const std::vector<double> thresholds = search.nextBatch(probeCount);
+                if (thresholds.empty()) {
+                    break; // rentang tidak dapat dipersempit lagi
+                }
+                result.searchRounds++;
+                Trace::Scope trace("search", "round " + std::to_string(result.searchRounds));
+                trace.arg("probes", static_cast<double>(thresholds.size()));
+
+                std::vector<Probe> batch;
+                if (pool && thresholds.size() > 1) {
+                    std::vector<std::future<Probe>> pending;
+                    for (double threshold : thresholds) {
+                        pending.push_back(pool->submit([&buildProbe, threshold]() { return buildProbe(threshold); }));
+                    }
+                    // Semua percobaan ditunggu sebelum error diteruskan; tidak ada tugas yang
+                    // masih berjalan saat putaran ini ditinggalkan
+                    std::exception_ptr error;
+                    for (auto& f : pending) {
+                        try {
+                            batch.push_back(f.get());
+                        } catch (...) {
+                            if (!error) {
+                                error = std::current_exception();
+                            }
+                        }
+                    }
+                    if (error) {
+                        std::rethrow_exception(error);
+                    }
+                } else {
+                    for (double threshold : thresholds) {
+                        batch.push_back(buildProbe(threshold));
+                    }
+                }
+
+                // Hanya pohon yang paling dekat ke target yang disimpan untuk encode berikutnya
+                double closestDiff = std::numeric_limits<double>::max();
+                for (size_t i = 0; i < thresholds.size(); ++i) {
+                    result.searchIterations++;
+                    auto& probe = probes[thresholds[i]];
+                    probe = {batch[i].tree->getNodeCount(), batch[i].features};
+                    const double estimated = estimator.estimate(probe.second);
+                    search.record({thresholds[i], probe.first, estimated});
+                    ioHandler.displayMessage("Iterasi " + std::to_string(result.searchIterations) + ": threshold = " + std::to_string(thresholds[i]) +
+                                             ", " + std::to_string(probe.first) + " simpul, perkiraan " + std::to_string(static_cast<long long>(estimated)) + " bytes");
+                    const double diff = std::abs(estimated - static_cast<double>(targetSizeBytes));
+                    if (diff < closestDiff && keepClosest) {
+                        closestDiff = diff;
+                        lastQt = std::move(batch[i].tree);
+                        lastQtThreshold = thresholds[i];
+                    }
+                }
+            }
+
+            const std::optional<ThresholdSearch::Sample> candidate = search.best();
+            if (!candidate) {
+                break;
+            }
+            const float candidateTh = static_cast<float>(candidate->threshold);
+            Trace::Scope trace("search", "encode candidate");
+            trace.arg("threshold", candidateTh);
+            if (!lastQt || lastQtThreshold != candidate->threshold) {
+                lastQt = buildProbe(candidate->threshold).tree;
+                lastQtThreshold = candidate->threshold;
+            }
+            // Di-encode di memori, bukan ke file sementara, agar beberapa kompresi bisa berjalan bersamaan
+            const uintmax_t currentSize = lastQt->reconstructImage().encodeToMemory(extension, options.jpgQuality).size();
+            result.searchEncodes++;
+            if (!keepClosest) {
+                lastQt.reset();
+            }
+            trace.arg("bytes", static_cast<double>(currentSize));
+
+            const long long currentDiff = static_cast<long long>(currentSize) - static_cast<long long>(targetSizeBytes);
+            ioHandler.displayMessage("  Ukuran hasil (" + extension + ") untuk threshold " + std::to_string(candidateTh) + ": " + std::to_string(currentSize) +
+                                     " bytes (Target: " + std::to_string(targetSizeBytes) + ", Selisih: " + std::to_string(currentDiff) + ")");
+            if (std::abs(currentDiff) < minDiff) {
+                minDiff = std::abs(currentDiff);
+                bestTh = candidateTh;
+            }
+            if (static_cast<double>(std::abs(currentDiff)) <= toleranceBytes) {
+                ioHandler.displayMessage("  Target tercapai dalam toleransi.");
+                break;
+            }
+
+            // Ukuran turun saat threshold naik, jadi sisi rentang yang salah dapat dibuang
+            estimator.calibrate(probes[candidate->threshold].second, currentSize);
+            if (currentSize > targetSizeBytes) {
+                minTh = candidateTh;
+            } else {
+                maxTh = candidateTh;
+            }
+            ioHandler.displayMessage("  Perkiraan dikalibrasi (skala " + std::to_string(estimator.getScale()) + "), rentang baru: [" +
+                                     std::to_string(minTh) + "..." + std::to_string(maxTh) + "]");
+            if ((maxTh - minTh) < 0.01f) {
+                ioHandler.displayMessage("  Rentang pencarian sangat kecil, dianggap konvergen.");
+                break;
+            }
+        } catch (const std::exception& e) {
+            ioHandler.displayError("  Error saat kompresi percobaan: " + std::string(e.what()));
+            ioHandler.displayMessage("  Menghentikan pencarian karena error. Menggunakan threshold terbaik sejauh ini: " + std::to_string(bestTh));
+            break;
+        }
+    }
+
+    ioHandler.displayMessage("Pencarian selesai. Threshold final diatur ke: " + std::to_string(bestTh));
+    return bestTh;
+}
+
+size_t Compressor::searchLeavesForTarget(const Image& sourceImage, uintmax_t inputBytes,
+                                         const CompressionOptions& options, const std::string& extension,
+                                         CompressionResult& result) const {
+    const uintmax_t targetSizeBytes = static_cast<uintmax_t>(static_cast<double>(inputBytes) * (1.0 - options.targetCompressionRatio));
+    const float toleranceRatio = 0.05f;
+    ioHandler.displayMessage("Target ukuran file: " + std::to_string(targetSizeBytes) + " bytes (Format: " + extension + ")");
+
+    // Penggabungan leaf menghapus urutan split, jadi hanya diterapkan pada pohon final
+    QuadtreeOptions probeOptions = treeOptionsFor(options);
+    probeOptions.mergeTolerance = -1;
+    Quadtree probe(sourceImage, options.metric, options.threshold, options.minBlockSize, probeOptions);
+    ioHandler.displayMessage("Pohon best-first dibangun sekali dengan " + std::to_string(probe.getSplitCount()) +
+                             " split; mencari jumlah split yang sesuai target.");
+
+    // Ukuran hasil naik seiring jumlah split, jadi jumlah split dicari dengan bisection
+    size_t lo = 0;
+    size_t hi = probe.getSplitCount();
+    size_t bestSplits = hi;
+    long long minDiff = std::numeric_limits<long long>::max();
+    int iterations = 0;
+    while (lo <= hi) {
+        const size_t mid = lo + (hi - lo) / 2;
+        ++iterations;
+        Trace::Scope trace("search", "iteration " + std::to_string(iterations));
+        trace.arg("splits", static_cast<double>(mid));
+
+        const uintmax_t currentSize = probe.reconstructImageAfterSplits(mid).encodeToMemory(extension, options.jpgQuality).size();
+        trace.arg("bytes", static_cast<double>(currentSize));
+        const long long currentDiff = static_cast<long long>(currentSize) - static_cast<long long>(targetSizeBytes);
+        ioHandler.displayMessage("Iterasi " + std::to_string(iterations) + ": " + std::to_string(probe.getLeafCountAfterSplits(mid)) +
+                                 " leaf -> " + std::to_string(currentSize) + " bytes (Selisih: " + std::to_string(currentDiff) + ")");
+
+        if (std::abs(currentDiff) < minDiff) {
+            minDiff = std::abs(currentDiff);
+            bestSplits = mid;
+        }
+        if (static_cast<double>(std::abs(currentDiff)) <= static_cast<double>(targetSizeBytes) * toleranceRatio) {
+            break;
+        }
+        if (currentSize > targetSizeBytes) {
+            if (mid == 0) {
+                break;
+            }
+            hi = mid - 1;
+        } else {
+            lo = mid + 1;
+        }
+    }
+    result.searchIterations = iterations;
+
+    const size_t leaves = probe.getLeafCountAfterSplits(bestSplits);
+    ioHandler.displayMessage("Pencarian selesai. Batas leaf final: " + std::to_string(leaves));
+    return leaves;
+}
+
+double Compressor::searchRateForTarget(const Image& sourceImage, uintmax_t inputBytes,
+                                       const CompressionOptions& options, const std::string& extension,
+                                       CompressionResult& result) const {
+    const uintmax_t targetSizeBytes = static_cast<uintmax_t>(static_cast<double>(inputBytes) * (1.0 - options.targetCompressionRatio));
+    const double toleranceBytes = static_cast<double>(targetSizeBytes) * 0.05;
+    const int maxIterations = 8;
+    ioHandler.displayMessage("Target ukuran file: " + std::to_string(targetSizeBytes) + " bytes (Format: " + extension + ")");
+
+    // Tebakan awal: model rate = ukuran target dalam bit. Setiap percobaan membangun pohon RD,
+    // meng-encode-nya, lalu target rate diskalakan dengan rasio target/ukuran sebenarnya.
+    // Ukuran naik seiring target rate, jadi percobaan yang terlalu besar/kecil membatasi
+    // rentang dan tebakan di luar rentang diganti titik tengah geometrisnya.
+    QuadtreeOptions probeOptions = treeOptionsFor(options);
+    probeOptions.mergeTolerance = -1;
+    double rate = static_cast<double>(targetSizeBytes) * 8.0;
+    double low = 0.0;   // target rate terbesar yang hasilnya masih di bawah target
+    double high = 0.0;  // target rate terkecil yang hasilnya di atas target (0 = belum ada)
+    double bestRate = rate;
+    uintmax_t bestSize = 0;
+    long long minDiff = std::numeric_limits<long long>::max();
+    int iterations = 0;
+    while (iterations < maxIterations && targetSizeBytes > 0) {
+        ++iterations;
+        Trace::Scope trace("search", "iteration " + std::to_string(iterations));
+        trace.arg("rateBits", rate);
+        probeOptions.targetRateBits = rate;
+        Quadtree probe(sourceImage, options.metric, options.threshold, options.minBlockSize, probeOptions);
+        const uintmax_t currentSize = probe.reconstructImage().encodeToMemory(extension, options.jpgQuality).size();
+        result.searchEncodes++;
+        trace.arg("bytes", static_cast<double>(currentSize));
+
+        const long long currentDiff = static_cast<long long>(currentSize) - static_cast<long long>(targetSizeBytes);
+        ioHandler.displayMessage("Iterasi " + std::to_string(iterations) + ": target rate " + std::to_string(static_cast<long long>(rate)) +
+                                 " bit, " + std::to_string(probe.getLeafCount()) + " leaf -> " + std::to_string(currentSize) +
+                                 " bytes (Selisih: " + std::to_string(currentDiff) + ")");
+        if (std::abs(currentDiff) < minDiff) {
+            minDiff = std::abs(currentDiff);
+            bestRate = rate;
+            bestSize = currentSize;
+        }
+        if (static_cast<double>(std::abs(currentDiff)) <= toleranceBytes) {
+            break;
+        }
+        if (currentSize > targetSizeBytes) {
+            high = rate;
+        } else {
+            if (probe.getLambda() == 0.0) {
+                break; // pohon penuh tidak dipangkas; target rate lebih besar tidak mengubah hasil
+            }
+            low = rate;
+        }
+
+        double next = rate * static_cast<double>(targetSizeBytes) / static_cast<double>(std::max<uintmax_t>(currentSize, 1));
+        if ((low > 0.0 && next <= low) || (high > 0.0 && next >= high)) {
+            next = (low > 0.0 && high > 0.0) ? std::sqrt(low * high) : rate;
+        }
+        if (std::abs(next - rate) <= rate * 1e-3) {
+            break;
+        }
+        rate = next;
+    }
+    result.searchIterations = iterations;
+
+    if (bestSize > 0 && inputBytes > 0) {
+        const double achieved = (1.0 - static_cast<double>(bestSize) / static_cast<double>(inputBytes)) * 100.0;
+        ioHandler.displayMessage("Pencarian selesai. Target rate final: " + std::to_string(static_cast<long long>(bestRate)) + " bit (" +
+                                 std::to_string(bestSize) + " bytes, rasio kompresi tercapai " + std::to_string(achieved) + "%).");
+    }
+    return bestRate;
+}
+
+float Compressor::searchThresholdForQuality(const Image& sourceImage, const CompressionOptions& options,
+                                            CompressionResult& result) const {
+    ioHandler.displayMessage("Mode target kualitas aktif (PSNR >= " + std::to_string(options.minPsnr) +
+                             " dB, SSIM >= " + std::to_string(options.minSsim) + ").");
+    // Kualitas setiap threshold dihitung inkremental dari SSE leaf pohon penuh, tanpa
+    // merekonstruksi gambar per percobaan
+    ThresholdSweep sweep(sourceImage, options.metric, options.minBlockSize, treeOptionsFor(options));
+    result.searchIterations = static_cast<int>(sweep.getPoints().size());
+    const std::vector<SweepPoint>& points = sweep.getPoints();
+    const SweepPoint* point = sweep.coarsestMeeting(options.minPsnr, options.minSsim);
+    if (!point) {
+        ioHandler.displayError("Target kualitas tidak tercapai bahkan dengan pohon penuh; menggunakan threshold 0.");
+        return 0.0f;
+    }
+
+    // Threshold float harus tetap di dalam [thresholdLow, thresholdHigh) agar pohon final sama;
+    // rentang yang lebih sempit dari presisi float dilewati ke titik berikutnya (pohon lebih besar).
+    // Mengembalikan indeks titik yang terwakili, atau points.size() jika tidak ada.
+    auto representable = [&points](size_t index, float& threshold) {
+        for (; index < points.size(); ++index) {
+            threshold = static_cast<float>(points[index].thresholdLow);
+            if (static_cast<double>(threshold) < points[index].thresholdLow) {
+                threshold = std::nextafter(threshold, std::numeric_limits<float>::infinity());
+            }
+            if (static_cast<double>(threshold) < points[index].thresholdHigh) {
+                break;
+            }
+        }
+        return index;
+    };
+    float threshold = 0.0f;
+    size_t chosen = representable(static_cast<size_t>(point - points.data()), threshold);
+    if (chosen == points.size()) {
+        // Titik terakhir mulai dari threshold 0 sehingga selalu terwakili; sampai di sini berarti
+        // kurva sweep rusak. Pohon penuh dipakai dan statusnya dilaporkan dari pohon final.
+        ioHandler.displayError("Tidak ada threshold float di rentang titik sweep yang memenuhi target kualitas; "
+                               "menggunakan threshold 0 (pohon penuh).");
+        return 0.0f;
+    }
+
+    // Sweep memakai pohon tanpa penggabungan; --merge menurunkan kualitas pohon final, sehingga
+    // titik dicek ulang dengan pohon gabungan dan digeser ke titik lebih halus sampai batas
+    // terpenuhi. Kualitas gabungan tidak dijamin monoton, tetapi titik yang dipilih selalu dicek.
+    if (options.mergeMode != MergeMode::NONE) {
+        const size_t pixelCount = sourceImage.getPixelCount();
+        auto mergedMeets = [&](float candidate) {
+            const Quadtree tree(sourceImage, options.metric, candidate, options.minBlockSize, treeOptionsFor(options));
+            double psnr = 0.0;
+            double ssim = 0.0;
+            measureOutputQuality(tree, options, pixelCount, psnr, ssim);
+            ++result.searchIterations;
+            return meetsQualityFloor(psnr, ssim, options);
+        };
+        if (!mergedMeets(threshold)) {
+            float finest = 0.0f;
+            size_t high = representable(points.size() - 1, finest);
+            if (high == points.size() || !mergedMeets(finest)) {
+                ioHandler.displayError("Target kualitas tidak tercapai dengan --merge bahkan dengan pohon penuh; "
+                                       "menggunakan threshold 0.");
+                return 0.0f;
+            }
+            // chosen gagal, high memenuhi: bagi dua indeks titik di antaranya
+            size_t low = chosen;
+            float highThreshold = finest;
+            while (high - low > 1) {
+                float candidate = 0.0f;
+                const size_t middle = representable(low + (high - low) / 2, candidate);
+                if (middle >= high) {
+                    low = low + (high - low) / 2;
+                } else if (mergedMeets(candidate)) {
+                    high = middle;
+                    highThreshold = candidate;
+                } else {
+                    low = middle;
+                }
+            }
+            chosen = high;
+            threshold = highThreshold;
+        }
+    }
+    ioHandler.displayMessage("Pencarian selesai. Threshold: " + std::to_string(threshold) + " (" +
+                             std::to_string(points[chosen].leaves) + " leaf sebelum penggabungan, PSNR sweep " +
+                             std::to_string(points[chosen].psnr) + " dB)");
+    return threshold;
+}
+
+float Compressor::resolveThreshold(const Image& sourceImage, uintmax_t inputBytes,
+                                   const CompressionOptions& options, const std::string& extension,
+                                   CompressionResult& result) const {
+    if (qualityTargetActive(options)) {
+        if (options.targetCompressionRatio > 0.0f) {
+            throw std::invalid_argument("Target kualitas (PSNR/SSIM) tidak dapat digabung dengan target rasio kompresi.");
+        }
+        if (options.buildMode != BuildMode::DEPTH_FIRST) {
+            throw std::invalid_argument("Target kualitas (PSNR/SSIM) hanya didukung untuk --build depth.");
+        }
+        Trace::Scope trace("search", "quality search");
+        auto searchStart = Clock::now();
+        float threshold = searchThresholdForQuality(sourceImage, options, result);
+        result.phases.searchMs = elapsedMs(searchStart);
+        return threshold;
+    }
+    if (options.targetCompressionRatio <= 0.0f) {
+        ioHandler.displayMessage("Mode target rasio kompresi dinonaktifkan. Menggunakan threshold manual: " + std::to_string(options.threshold));
+        return options.threshold;
+    }
+
+    // Pencarian threshold depth-first bergantung pada SizeEstimator, yang fiturnya (warna
+    // berbeda, kontras tepi) mengasumsikan leaf warna rata; best-first dan rd mengukur encode asli
+    if (options.buildMode == BuildMode::DEPTH_FIRST && options.leafModel == LeafModel::PLANE) {
+        throw std::invalid_argument("Mode target dengan --build depth tidak mendukung --leaf-model plane; gunakan --build best atau rd.");
+    }
+    ioHandler.displayMessage("Mode target rasio kompresi aktif (" + std::to_string(options.targetCompressionRatio * 100.0f) + "%).");
+    if (inputBytes == 0) {
+        ioHandler.displayError("Ukuran file asli tidak valid (0 bytes). Tidak dapat menggunakan mode target.");
+        ioHandler.displayMessage("Menggunakan threshold manual: " + std::to_string(options.threshold));
+        return options.threshold;
+    }
+
+    Trace::Scope trace("search", "threshold search");
+    auto searchStart = Clock::now();
+    float threshold = options.threshold;
+    if (options.buildMode == BuildMode::RATE_DISTORTION) {
+        // Threshold tidak dipakai; pohon final memilih breakpoint lambda dari target rate
+        result.targetRateBits = searchRateForTarget(sourceImage, inputBytes, options, extension, result);
+    } else if (options.buildMode == BuildMode::BEST_FIRST) {
+        // Threshold tetap menjadi target error; yang dicari adalah jumlah leaf
+        result.finalMaxLeaves = searchLeavesForTarget(sourceImage, inputBytes, options, extension, result);
+    } else {
+        threshold = searchThresholdForTarget(sourceImage, inputBytes, options, extension, result);
+    }
+    result.phases.searchMs = elapsedMs(searchStart);
+    return threshold;
+}
+
+void Compressor::compress(const Image& sourceImage, const CompressionOptions& options,
+                          CompressionResult& result) const {
+    result.imageWidth = sourceImage.getWidth();
+    result.imageHeight = sourceImage.getHeight();
+
+    std::string outputImageFilePath = options.outputPath;
+    std::string outputImageExtension = ".png";
+    fs::path outPathObj(outputImageFilePath);
+    if (outPathObj.has_extension()) {
+        outputImageExtension = IOHandler::toLower(outPathObj.extension().string());
+    } else {
+         outputImageFilePath += outputImageExtension;
+         ioHandler.displayMessage("Ekstensi output tidak ada, menggunakan default " + outputImageExtension);
+    }
+
+    auto startTime = Clock::now();
+
+    float finalThreshold = resolveThreshold(sourceImage, result.inputBytes, options, outputImageExtension, result);
+    result.finalThreshold = finalThreshold;
+
+    ioHandler.displayMessage("Melakukan kompresi gambar final dengan threshold: " + std::to_string(finalThreshold));
+    auto phaseStart = Clock::now();
+    Quadtree finalQt(sourceImage, options.metric, finalThreshold, options.minBlockSize, finalTreeOptions(options, result));
+    result.phases.buildMs = elapsedMs(phaseStart);
+
+    phaseStart = Clock::now();
+    double regionSquaredError = 0.0;
+    Image resultImg = reconstructFinal(finalQt, options, result, regionSquaredError);
+    result.phases.reconstructMs = elapsedMs(phaseStart);
+
+    phaseStart = Clock::now();
+    {
+        Trace::Scope trace("io", "encode");
+        trace.arg("path", outputImageFilePath);
+        resultImg.saveImage(outputImageFilePath, options.jpgQuality);
+    }
+    result.phases.encodeMs = elapsedMs(phaseStart);
+    ioHandler.displayMessage("Gambar Berhasil Dikompresi dan disimpan ke: " + outputImageFilePath);
+
+    try {
+         if (fs::exists(outputImageFilePath)) {
+            result.outputBytes = fs::file_size(outputImageFilePath);
+         } else {
+             ioHandler.displayError("Warning: File gambar output tidak ditemukan setelah penyimpanan. Ukuran tidak dapat diukur.");
+         }
+     } catch (const fs::filesystem_error& e) {
+         ioHandler.displayError("Warning: Tidak dapat mengukur ukuran file gambar output: " + std::string(e.what()));
+     }
+
+    recordTreeStats(finalQt, result, regionSquaredError);
+    if (qualityTargetActive(options)) {
+        result.qualityFloorMet = meetsQualityFloor(result.psnr, result.ssim, options);
+    }
+    if (finalQt.isBudgetLimited()) {
+        ioHandler.displayMessage("Pohon melebihi batas memori " + std::to_string(options.maxTreeMemoryMB) +
+                                 " MB; ukuran blok minimum diperbesar menjadi " + std::to_string(result.effectiveMinBlockSize));
+    }
+
+    if (!options.gifPath.empty()) {
+        ioHandler.displayMessage("Membuat file GIF (frame dibuat dan di-encode secara paralel)...");
+        phaseStart = Clock::now();
+        Trace::Scope trace("gif", "gif");
+        // Satu frame per level pohon final, sehingga tidak ada frame duplikat
+        GifSchedule schedule = GifSchedule::fromTree(finalQt, options.metric, finalThreshold, options.minBlockSize);
+        if (MakeGif::create(sourceImage, &finalQt, schedule, options.gifPath, options.threads)) {
+            ioHandler.displayMessage("GIF berhasil dibuat: " + options.gifPath);
+        } else {
+            ioHandler.displayError("GIF gagal dibuat: " + options.gifPath);
+        }
+        result.phases.gifMs = elapsedMs(phaseStart);
+    }
+
+    result.execTimeMs = elapsedMs(startTime);
+    result.peakRssKB = ResourceUsage::peakResidentSetKB();
+}
+
+void Compressor::compressToMemory(const Image& sourceImage, const CompressionOptions& options,
+                                  const std::string& extension, std::vector<unsigned char>& encoded,
+                                  CompressionResult& result) const {
+    result.imageWidth = sourceImage.getWidth();
+    result.imageHeight = sourceImage.getHeight();
+
+    auto startTime = Clock::now();
+
+    float finalThreshold = resolveThreshold(sourceImage, result.inputBytes, options, extension, result);
+    result.finalThreshold = finalThreshold;
+
+    auto phaseStart = Clock::now();
+    Quadtree finalQt(sourceImage, options.metric, finalThreshold, options.minBlockSize, finalTreeOptions(options, result));
+    result.phases.buildMs = elapsedMs(phaseStart);
+
+    phaseStart = Clock::now();
+    double regionSquaredError = 0.0;
+    Image resultImg = reconstructFinal(finalQt, options, result, regionSquaredError);
+    result.phases.reconstructMs = elapsedMs(phaseStart);
+
+    phaseStart = Clock::now();
+    {
+        Trace::Scope trace("io", "encode");
+        encoded = resultImg.encodeToMemory(extension, options.jpgQuality);
+    }
+    result.phases.encodeMs = elapsedMs(phaseStart);
+
+    result.outputBytes = encoded.size();
+    recordTreeStats(finalQt, result, regionSquaredError);
+    if (qualityTargetActive(options)) {
+        result.qualityFloorMet = meetsQualityFloor(result.psnr, result.ssim, options);
+    }
+
+    result.execTimeMs = elapsedMs(startTime);
+    result.peakRssKB = ResourceUsage::peakResidentSetKB();
+}
+
+void Compressor::sweep(const Image& sourceImage, const CompressionOptions& options, CompressionResult& result) const {
+    // Perkiraan ukuran per titik memakai fitur leaf warna rata (SizeEstimator)
+    if (options.leafModel == LeafModel::PLANE) {
+        throw std::invalid_argument("--sweep tidak mendukung --leaf-model plane.");
+    }
+    result.imageWidth = sourceImage.getWidth();
+    result.imageHeight = sourceImage.getHeight();
+
+    // Format perkiraan ukuran mengikuti --output jika ada
+    std::string extension = IOHandler::toLower(fs::path(options.outputPath).extension().string());
+    if (extension.empty()) {
+        extension = ".png";
+    }
+
+    auto startTime = Clock::now();
+    ioHandler.displayMessage("Membangun pohon penuh untuk sweep threshold...");
+    ThresholdSweep sweep(sourceImage, options.metric, options.minBlockSize, treeOptionsFor(options));
+    result.phases.buildMs = elapsedMs(startTime);
+
+    auto phaseStart = Clock::now();
+    sweep.measureSizes(extension, options.jpgQuality, options.sweepEncodeCount);
+    result.phases.encodeMs = elapsedMs(phaseStart);
+
+    std::ofstream out(options.sweepPath);
+    if (!out) {
+        throw std::runtime_error("Tidak dapat menulis file sweep: " + options.sweepPath);
+    }
+    sweep.writeCsv(out);
+    out.close();
+    if (!out) {
+        throw std::runtime_error("Gagal menulis file sweep: " + options.sweepPath);
+    }
+
+    recordTreeStats(sweep.getFullTree(), result);
+    result.execTimeMs = elapsedMs(startTime);
+    result.peakRssKB = ResourceUsage::peakResidentSetKB();
+    ioHandler.displayMessage(std::to_string(sweep.getPoints().size()) + " titik sweep ditulis ke: " + options.sweepPath);
+}
@@ -0,0 +1,62 @@
+#ifndef COMPRESSOR_H
+#define COMPRESSOR_H
+
+#include <string>
+#include <cstdint>
+#include <vector>
+#include "Image.h"
+#include "IOHandler.h"
+#include "CompressionOptions.h"
+
+// Alur kompresi lengkap (pencarian threshold, pembentukan pohon, penyimpanan, GIF)
+// yang dipakai bersama oleh mode interaktif dan mode command line.
+class Compressor {
+private:
+    const IOHandler& ioHandler;
+
+    float searchThresholdForTarget(const Image& sourceImage, uintmax_t inputBytes,
+                                   const CompressionOptions& options, const std::string& extension,
+                                   CompressionResult& result) const;
+    // Mode target untuk BEST_FIRST: satu pohon dibangun sekali, lalu jumlah split dicari dengan
+    // rekonstruksi awalan pohon. Mengembalikan batas leaf untuk pohon final.
+    size_t searchLeavesForTarget(const Image& sourceImage, uintmax_t inputBytes,
+                                 const CompressionOptions& options, const std::string& extension,
+                                 CompressionResult& result) const;
+    // Mode target untuk RATE_DISTORTION: model rate pohon (bit penanda + warna leaf) tidak sama
+    // dengan ukuran file, jadi target rate dikalibrasi dengan encode sebenarnya. Mengembalikan
+    // target rate (bit model) untuk pohon final.
+    double searchRateForTarget(const Image& sourceImage, uintmax_t inputBytes,
+                               const CompressionOptions& options, const std::string& extension,
+                               CompressionResult& result) const;
+    // Mode target kualitas: threshold terbesar yang PSNR/SSIM pohonnya memenuhi batas minimum,
+    // dipilih dari kurva sweep satu pohon penuh
+    float searchThresholdForQuality(const Image& sourceImage, const CompressionOptions& options,
+                                    CompressionResult& result) const;
+    // Threshold manual, atau hasil pencarian jika mode target aktif
+    float resolveThreshold(const Image& sourceImage, uintmax_t inputBytes,
+                           const CompressionOptions& options, const std::string& extension,
+                           CompressionResult& result) const;
+
+public:
+    explicit Compressor(const IOHandler& io) : ioHandler(io) {}
+
+    // Memuat gambar input; mengisi stats.inputBytes (0 jika tidak dapat diukur) dan stats.phases.loadMs
+    Image loadInput(const std::string& inputPath, CompressionResult& stats) const;
+
+    // Mengompresi sourceImage ke options.outputPath (dan GIF jika diminta). result sebaiknya
+    // berasal dari loadInput agar ukuran input dan waktu muat ikut tercatat.
+    void compress(const Image& sourceImage, const CompressionOptions& options,
+                  CompressionResult& result) const;
+
+    // Sama seperti compress, tetapi hasil di-encode ke memori (format sesuai extension)
+    // tanpa menyentuh disk; options.outputPath dan options.gifPath diabaikan.
+    void compressToMemory(const Image& sourceImage, const CompressionOptions& options,
+                          const std::string& extension, std::vector<unsigned char>& encoded,
+                          CompressionResult& result) const;
+
+    // Menulis kurva rate/kualitas semua threshold ke options.sweepPath (CSV) dari satu pohon
+    // penuh, tanpa menyimpan gambar. Statistik result berisi pohon penuh tersebut.
+    void sweep(const Image& sourceImage, const CompressionOptions& options, CompressionResult& result) const;
+};
+
+#endif // COMPRESSOR_H
@@ -11,131 +11,232 @@ void IOHandler::clearInputBuffer() const {
     std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
 }
 
-std::string IOHandler::promptForInputPath() {
-    std::string filePath;
+
+std::string IOHandler::toLower(std::string text) {
+    std::transform(text.begin(), text.end(), text.begin(),
+                   [](unsigned char c){ return std::tolower(c); });
+    return text;
+}
+
+namespace {
+
+std::string joinExtensions(const std::vector<std::string>& extensions) {
+    std::string joined;
+    for (size_t i = 0; i < extensions.size(); ++i) {
+        joined += extensions[i] + (i == extensions.size() - 1 ? "" : ", ");
+    }
+    return joined;
+}
+
+// Pemeriksaan nama file dan direktori induk yang sama untuk output gambar, GIF dan CSV sweep
+bool validateOutputLocation(const fs::path& outputPath, const std::string& label, std::string& error) {
+    if (outputPath.has_parent_path()) {
+        if (!outputPath.parent_path().empty() && !fs::exists(outputPath.parent_path())) {
+            error = "Direktori induk untuk path " + label + " tidak ditemukan: " + outputPath.parent_path().string();
+            return false;
+        } else if (!outputPath.parent_path().empty() && !fs::is_directory(outputPath.parent_path())) {
+            error = "Path induk untuk " + label + " bukanlah direktori: " + outputPath.parent_path().string();
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+bool IOHandler::validateInputPath(const std::string& filePath, bool requireAbsolute, std::string& error) const {
     const std::vector<std::string> supportedExtensions = {
         ".jpg", ".jpeg", ".png"
     };
 
-    while (true) {
-        std::cout << "1. Masukkan Alamat Absolut Gambar Input (contoh: C:/Users/Nama/Pictures/gambar.png): ";
-        std::getline(std::cin >> std::ws, filePath);
-        try {
-            fs::path inputPath(filePath);
-
-            if (!inputPath.is_absolute()) {
-                displayError("Path input harus berupa path absolut.");
-                continue;
-            }
+    try {
+        fs::path inputPath(filePath);
 
+        if (requireAbsolute && !inputPath.is_absolute()) {
+            error = "Path input harus berupa path absolut.";
+            return false;
+        }
 
-            if (fs::exists(inputPath) && fs::is_regular_file(inputPath)) {
-                if (inputPath.has_extension()) {
-                    std::string ext = inputPath.extension().string();
-                    std::transform(ext.begin(), ext.end(), ext.begin(),
-                                   [](unsigned char c){ return std::tolower(c); });
-
-                    bool found = false;
-                    for(const auto& supportedExt : supportedExtensions) {
-                        if (ext == supportedExt) {
-                            found = true;
-                            break;
-                        }
-                    }
-
-                    if (found) {
-                        return filePath;
-                    } else {
-                        std::string supportedExtStr;
-                        for(size_t i = 0; i < supportedExtensions.size(); ++i) {
-                            supportedExtStr += supportedExtensions[i] + (i == supportedExtensions.size() - 1 ? "" : ", ");
-                        }
-                        displayError("Ekstensi file input '" + inputPath.extension().string() + "' tidak didukung. Gunakan salah satu dari: " + supportedExtStr);
-                    }
-                } else {
-                     displayError("File tidak memiliki ekstensi yang dikenali.");
-                }
+        if (!fs::exists(inputPath) || !fs::is_regular_file(inputPath)) {
+            error = "File tidak ditemukan atau bukan file reguler di path: " + filePath;
+            return false;
+        }
+        if (!inputPath.has_extension()) {
+            error = "File tidak memiliki ekstensi yang dikenali.";
+            return false;
+        }
 
-            } else {
-                displayError("File tidak ditemukan atau bukan file reguler di path: " + filePath);
-            }
-        } catch (const fs::filesystem_error& e) {
-             displayError("Filesystem error saat memeriksa path input: " + std::string(e.what()));
-        } catch (const std::exception& e) {
-             displayError("Error saat memproses path input: " + std::string(e.what()));
+        std::string ext = toLower(inputPath.extension().string());
+        if (std::find(supportedExtensions.begin(), supportedExtensions.end(), ext) == supportedExtensions.end()) {
+            error = "Ekstensi file input '" + inputPath.extension().string() + "' tidak didukung. Gunakan salah satu dari: " + joinExtensions(supportedExtensions);
+            return false;
         }
+        return true;
+    } catch (const fs::filesystem_error& e) {
+        error = "Filesystem error saat memeriksa path input: " + std::string(e.what());
+    } catch (const std::exception& e) {
+        error = "Error saat memproses path input: " + std::string(e.what());
     }
+    return false;
 }
 
-std::string IOHandler::promptForOutputPath() {
-    std::string filePath;
-     const std::vector<std::string> supportedOutputExtensions = {
+bool IOHandler::validateOutputPath(const std::string& filePath, bool requireAbsolute, std::string& error) const {
+    const std::vector<std::string> supportedOutputExtensions = {
         ".png", ".jpg", ".jpeg"
     };
 
-    while (true) {
-        std::cout << "6. Masukkan Alamat Absolut Gambar Hasil Kompresi (ekstensi: .png, .jpg, .jpeg): ";
-        std::getline(std::cin >> std::ws, filePath);
-        try {
-            fs::path outputPath(filePath);
+    try {
+        fs::path outputPath(filePath);
 
-            if (!outputPath.is_absolute()) {
-                displayError("Path input harus berupa path absolut.");
-                continue;
-            }
+        if (requireAbsolute && !outputPath.is_absolute()) {
+            error = "Path input harus berupa path absolut.";
+            return false;
+        }
 
-            if (!outputPath.has_filename() || outputPath.filename().empty() || outputPath.filename() == "." || outputPath.filename() == "..") {
-                 displayError("Nama file output tidak valid atau kosong.");
-                 continue;
-            }
+        if (!outputPath.has_filename() || outputPath.filename().empty() || outputPath.filename() == "." || outputPath.filename() == "..") {
+            error = "Nama file output tidak valid atau kosong.";
+            return false;
+        }
 
-             if (!outputPath.has_extension()) {
-                 displayError("Nama file output harus memiliki ekstensi (contoh: .png, .jpg).");
-                 continue;
-             }
-             std::string ext = outputPath.extension().string();
-             std::transform(ext.begin(), ext.end(), ext.begin(),
-                            [](unsigned char c){ return std::tolower(c); });
-
-             bool outputExtSupported = false;
-             for(const auto& supportedExt : supportedOutputExtensions) {
-                 if (ext == supportedExt) {
-                     outputExtSupported = true;
-                     break;
-                 }
-             }
-             if (!outputExtSupported) {
-                 std::string supportedExtStr;
-                 for(size_t i = 0; i < supportedOutputExtensions.size(); ++i) {
-                     supportedExtStr += supportedOutputExtensions[i] + (i == supportedOutputExtensions.size() - 1 ? "" : ", ");
-                 }
-                 displayError("Ekstensi file output '" + outputPath.extension().string() + "' tidak didukung untuk kompresi gambar. Gunakan: " + supportedExtStr);
-                 continue;
-             }
-
-
-            if (outputPath.has_parent_path()) {
-                 if (!outputPath.parent_path().empty() && !fs::exists(outputPath.parent_path())) {
-                    displayError("Direktori induk untuk path output tidak ditemukan: " + outputPath.parent_path().string());
-                    continue;
-                 } else if (!outputPath.parent_path().empty() && !fs::is_directory(outputPath.parent_path())) {
-                    displayError("Path induk untuk output bukanlah direktori: " + outputPath.parent_path().string());
-                    continue;
-                 }
-            }
+        if (!outputPath.has_extension()) {
+            error = "Nama file output harus memiliki ekstensi (contoh: .png, .jpg).";
+            return false;
+        }
+        std::string ext = toLower(outputPath.extension().string());
+        if (std::find(supportedOutputExtensions.begin(), supportedOutputExtensions.end(), ext) == supportedOutputExtensions.end()) {
+            error = "Ekstensi file output '" + outputPath.extension().string() + "' tidak didukung untuk kompresi gambar. Gunakan: " + joinExtensions(supportedOutputExtensions);
+            return false;
+        }
+
+        return validateOutputLocation(outputPath, "output", error);
+    } catch (const fs::filesystem_error& e) {
+        error = "Filesystem error saat memeriksa path output: " + std::string(e.what());
+    } catch (const std::exception& e) {
+        error = "Error saat memproses path output: " + std::string(e.what());
+    }
+    return false;
+}
+
+bool IOHandler::validateGifOutputPath(const std::string& filePath, bool requireAbsolute, std::string& error) const {
+    const std::string gifExtension = ".gif";
+
+    try {
+        fs::path outputPath(filePath);
+
+        if (requireAbsolute && !outputPath.is_absolute()) {
+            error = "Path input harus berupa path absolut.";
+            return false;
+        }
+
+        if (!outputPath.has_filename() || outputPath.filename().empty() || outputPath.filename() == "." || outputPath.filename() == "..") {
+            error = "Nama file GIF tidak valid atau kosong.";
+            return false;
+        }
+
+        if (!outputPath.has_extension()) {
+            error = "Nama file GIF harus memiliki ekstensi .gif";
+            return false;
+        }
+        if (toLower(outputPath.extension().string()) != gifExtension) {
+            error = "Ekstensi file output GIF harus .gif";
+            return false;
+        }
+
+        return validateOutputLocation(outputPath, "output GIF", error);
+    } catch (const fs::filesystem_error& e) {
+        error = "Filesystem error saat memeriksa path output GIF: " + std::string(e.what());
+    } catch (const std::exception& e) {
+        error = "Error saat memproses path output GIF: " + std::string(e.what());
+    }
+    return false;
+}
+
+void IOHandler::getThresholdRange(ErrorMetric metric, std::string& metricName, float& minVal, float& maxVal) {
+    minVal = 0.0f;
+    maxVal = std::numeric_limits<float>::max();
+
+    if (metric == ErrorMetric::VARIANCE) {
+        metricName = "Variance";
+        maxVal = 255.0f * 255.0f;
+    } else if (metric == ErrorMetric::MAD) {
+        metricName = "MAD";
+        maxVal = 255.0f;
+    } else if (metric == ErrorMetric::MAX_PIXEL_DIFFERENCE) {
+        metricName = "Max Pixel Difference";
+        maxVal = 255.0f;
+    } else if (metric == ErrorMetric::ENTROPY) {
+        metricName = "Entropy";
+        maxVal = 8.0f;
+    } else if (metric == ErrorMetric::SSIM) {
+        metricName = "SSIM Error (1-SSIM)";
+        maxVal = 1.0f;
+    } else {
+        metricName = "Unknown Metric";
+    }
+}
+
+bool IOHandler::validateThreshold(ErrorMetric metric, float value, std::string& error) const {
+    std::string metricName;
+    float minVal, maxVal;
+    getThresholdRange(metric, metricName, minVal, maxVal);
+    if (value >= minVal && value <= maxVal) {
+        return true;
+    }
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(4);
+    ss << "Masukan tidak valid. Threshold untuk " << metricName
+       << " harus berada dalam rentang [" << minVal << ".." << maxVal << "].";
+    error = ss.str();
+    return false;
+}
+
+bool IOHandler::validateMinBlockSize(int value, std::string& error) const {
+    if (value >= 1) {
+        return true;
+    }
+    error = "Masukan tidak valid. Harap masukkan angka bulat >= 1.";
+    return false;
+}
+
+bool IOHandler::validateTargetCompression(float value, std::string& error) const {
+    if (value >= 0.0f && value < 1.0f) {
+        return true;
+    }
+    error = "Masukan tidak valid. Harap masukkan angka antara 0.0 (inklusif) dan 1.0 (eksklusif).";
+    return false;
+}
+
+std::string IOHandler::promptForInputPath() {
+    std::string filePath;
+    std::string error;
+
+    while (true) {
+        std::cout << "1. Masukkan Alamat Absolut Gambar Input (contoh: C:/Users/Nama/Pictures/gambar.png): ";
+        std::getline(std::cin >> std::ws, filePath);
+        if (validateInputPath(filePath, true, error)) {
             return filePath;
+        }
+        displayError(error);
+    }
+}
 
-        } catch (const fs::filesystem_error& e) {
-            displayError("Filesystem error saat memeriksa path output: " + std::string(e.what()));
-        } catch (const std::exception& e) {
-             displayError("Error saat memproses path output: " + std::string(e.what()));
+std::string IOHandler::promptForOutputPath() {
+    std::string filePath;
+    std::string error;
+
+    while (true) {
+        std::cout << "6. Masukkan Alamat Absolut Gambar Hasil Kompresi (ekstensi: .png, .jpg, .jpeg): ";
+        std::getline(std::cin >> std::ws, filePath);
+        if (validateOutputPath(filePath, true, error)) {
+            return filePath;
         }
+        displayError(error);
     }
 }
 
 std::string IOHandler::promptForGifOutputPath() {
     std::string filePath;
-    const std::string gifExtension = ".gif";
+    std::string error;
 
     while (true) {
         std::cout << "7. Masukkan Alamat Absolut Output GIF [Bonus] (opsional, tekan Enter untuk skip): ";
@@ -145,49 +246,10 @@ std::string IOHandler::promptForGifOutputPath() {
             displayMessage("Output GIF dilewati.");
             return "";
         }
-
-        try {
-            fs::path outputPath(filePath);
-
-            if (!outputPath.is_absolute()) {
-                displayError("Path input harus berupa path absolut.");
-                continue;
-            }
-
-            if (!outputPath.has_filename() || outputPath.filename().empty() || outputPath.filename() == "." || outputPath.filename() == "..") {
-                 displayError("Nama file GIF tidak valid atau kosong.");
-                 continue;
-            }
-
-            if (!outputPath.has_extension()) {
-                 displayError("Nama file GIF harus memiliki ekstensi .gif");
-                 continue;
-            }
-             std::string ext = outputPath.extension().string();
-             std::transform(ext.begin(), ext.end(), ext.begin(),
-                            [](unsigned char c){ return std::tolower(c); });
-
-            if (ext != gifExtension) {
-                 displayError("Ekstensi file output GIF harus .gif");
-                 continue;
-            }
-
-            if (outputPath.has_parent_path()) {
-                 if (!outputPath.parent_path().empty() && !fs::exists(outputPath.parent_path())) {
-                    displayError("Direktori induk untuk path output GIF tidak ditemukan: " + outputPath.parent_path().string());
-                    continue;
-                 } else if (!outputPath.parent_path().empty() && !fs::is_directory(outputPath.parent_path())) {
-                    displayError("Path induk untuk output GIF bukanlah direktori: " + outputPath.parent_path().string());
-                    continue;
-                 }
-            }
+        if (validateGifOutputPath(filePath, true, error)) {
             return filePath;
-
-        } catch (const fs::filesystem_error& e) {
-            displayError("Filesystem error saat memeriksa path output GIF: " + std::string(e.what()));
-        } catch (const std::exception& e) {
-             displayError("Error saat memproses path output GIF: " + std::string(e.what()));
         }
+        displayError(error);
     }
 }
 
@@ -210,13 +272,13 @@ ErrorMetric IOHandler::promptForErrorMetric() {
                 case 3: selectedMetric = ErrorMetric::MAX_PIXEL_DIFFERENCE; break;
                 case 4: selectedMetric = ErrorMetric::ENTROPY; break;
                 case 5: selectedMetric = ErrorMetric::SSIM; break;
-                
+
             }
-            return selectedMetric; 
+            return selectedMetric;
         } else {
             displayError("   Masukan tidak valid. Harap masukkan angka bulat antara 1 dan 5.");
-            std::cin.clear(); 
-            clearInputBuffer(); 
+            std::cin.clear();
+            clearInputBuffer();
         }
     }
 }
@@ -224,55 +286,26 @@ ErrorMetric IOHandler::promptForErrorMetric() {
 float IOHandler::promptForThreshold() {
     float value;
     std::string metricName;
-    float min_val = 0.0; 
-    float max_val = std::numeric_limits<float>::max(); 
-
-    if (selectedMetric == ErrorMetric::VARIANCE) {
-        metricName = "Variance";
-        min_val = 0.0;
-        max_val = 255.0 * 255.0;
-    } else if (selectedMetric == ErrorMetric::MAD) {
-        metricName = "MAD";
-        min_val = 0.0;
-        max_val = 255.0;
-    } else if (selectedMetric == ErrorMetric::MAX_PIXEL_DIFFERENCE) {
-        metricName = "Max Pixel Difference";
-        min_val = 0.0;
-        max_val = 255.0;
-    } else if (selectedMetric == ErrorMetric::ENTROPY) {
-        metricName = "Entropy";
-        min_val = 0.0;
-        max_val = 8.0; 
-    } else if (selectedMetric == ErrorMetric::SSIM) {
-        metricName = "SSIM Error (1-SSIM)";
-        min_val = 0.0;
-        max_val = 1.0; 
-    } else {
-        metricName = "Unknown Metric";
-    }
+    float min_val, max_val;
+    std::string error;
+    getThresholdRange(selectedMetric, metricName, min_val, max_val);
 
-    std::cout << std::fixed << std::setprecision(4); 
+    std::cout << std::fixed << std::setprecision(4);
     std::cout << "   (Rentang valid untuk " << metricName << " adalah [" << min_val << ".." << max_val << "])" << std::endl;
-    std::cout << std::defaultfloat; 
+    std::cout << std::defaultfloat;
 
     while (true) {
         std::cout << "3. Masukkan ambang batas (threshold): ";
         if (std::cin >> value) {
-            if (value >= min_val && value <= max_val) {
-                clearInputBuffer(); 
-                return value;       
-            } else {
-                std::stringstream ss;
-                ss << std::fixed << std::setprecision(4);
-                ss << "   Masukan tidak valid. Threshold untuk " << metricName
-                   << " harus berada dalam rentang [" << min_val << ".." << max_val << "].";
-                displayError(ss.str());
-                clearInputBuffer(); 
+            clearInputBuffer();
+            if (validateThreshold(selectedMetric, value, error)) {
+                return value;
             }
+            displayError("   " + error);
         } else {
-            
+
             displayError("   Masukan tidak valid. Harap masukkan angka.");
-            std::cin.clear(); 
+            std::cin.clear();
             clearInputBuffer();
         }
     }
@@ -280,9 +313,10 @@ float IOHandler::promptForThreshold() {
 
 int IOHandler::promptForMinBlockSize() {
     int value;
+    std::string error;
     while (true) {
         std::cout << "4. Masukkan ukuran minimum Blok (luas piksel, >= 1): ";
-        if (std::cin >> value && value >= 1) {
+        if (std::cin >> value && validateMinBlockSize(value, error)) {
             clearInputBuffer();
             return value;
         } else {
@@ -295,9 +329,10 @@ int IOHandler::promptForMinBlockSize() {
 
 float IOHandler::promptForTargetCompressionPercentage() {
     float value;
+    std::string error;
     while (true) {
         std::cout << "5. Masukkan Target Rasio Kompresi [Bonus] (0 nonaktif, 0 < target < 1.0): ";
-        if (std::cin >> value && value >= 0.0f && value < 1.0f) {
+        if (std::cin >> value && validateTargetCompression(value, error)) {
             clearInputBuffer();
             return value;
         } else {
@@ -308,12 +343,327 @@ float IOHandler::promptForTargetCompressionPercentage() {
     }
 }
 
+namespace {
+
+// Angka dari argumen harus dibaca utuh; "12abc" ditolak
+template <typename T>
+T parseNumber(const std::string& flag, const std::string& text) {
+    std::istringstream in(text);
+    T value;
+    if (!(in >> value) || !(in >> std::ws).eof()) {
+        throw std::invalid_argument("Nilai untuk " + flag + " bukan angka yang valid: " + text);
+    }
+    return value;
+}
+
+} // namespace
+
+float IOHandler::parseFloat(const std::string& name, const std::string& text) {
+    return parseNumber<float>(name, text);
+}
+
+int IOHandler::parseInt(const std::string& name, const std::string& text) {
+    return parseNumber<int>(name, text);
+}
+
+void IOHandler::applyMaxLeaves(int leaves, CompressionOptions& options) {
+    if (leaves < 0) {
+        throw std::invalid_argument("Batas leaf tidak boleh negatif.");
+    }
+    options.maxLeaves = static_cast<size_t>(leaves);
+    if (leaves > 0) {
+        options.buildMode = BuildMode::BEST_FIRST;
+    }
+}
+
+void IOHandler::applyMinPsnr(double psnr, CompressionOptions& options) {
+    if (psnr < 0.0) {
+        throw std::invalid_argument("PSNR minimum tidak boleh negatif.");
+    }
+    options.minPsnr = psnr;
+}
+
+void IOHandler::applyMinSsim(double ssim, CompressionOptions& options) {
+    if (ssim < 0.0 || ssim > 1.0) {
+        throw std::invalid_argument("SSIM minimum harus di antara 0 dan 1.");
+    }
+    options.minSsim = ssim;
+}
+
+ErrorMetric IOHandler::parseMetric(const std::string& text) {
+    const std::string name = toLower(text);
+    if (name == "1" || name == "variance") return ErrorMetric::VARIANCE;
+    if (name == "2" || name == "mad") return ErrorMetric::MAD;
+    if (name == "3" || name == "max" || name == "mpd") return ErrorMetric::MAX_PIXEL_DIFFERENCE;
+    if (name == "4" || name == "entropy") return ErrorMetric::ENTROPY;
+    if (name == "5" || name == "ssim") return ErrorMetric::SSIM;
+    throw std::invalid_argument("Metode error tidak dikenal: " + text + " (gunakan variance, mad, max, entropy, ssim atau 1-5)");
+}
+
+BuildMode IOHandler::parseBuildMode(const std::string& text) {
+    const std::string name = toLower(text);
+    if (name == "depth") return BuildMode::DEPTH_FIRST;
+    if (name == "best") return BuildMode::BEST_FIRST;
+    if (name == "rd") return BuildMode::RATE_DISTORTION;
+    throw std::invalid_argument("Mode pembentukan pohon tidak dikenal: " + text + " (gunakan depth, best atau rd)");
+}
+
+SplitMode IOHandler::parseSplitMode(const std::string& text) {
+    const std::string name = toLower(text);
+    if (name == "quad") return SplitMode::QUAD;
+    if (name == "adaptive") return SplitMode::ADAPTIVE;
+    throw std::invalid_argument("Mode pembagian blok tidak dikenal: " + text + " (gunakan quad atau adaptive)");
+}
+
+MergeMode IOHandler::parseMergeMode(const std::string& text) {
+    const std::string name = toLower(text);
+    if (name == "none") return MergeMode::NONE;
+    if (name == "siblings") return MergeMode::SIBLINGS;
+    if (name == "regions") return MergeMode::REGIONS;
+    throw std::invalid_argument("Mode penggabungan leaf tidak dikenal: " + text + " (gunakan none, siblings atau regions)");
+}
+
+LeafModel IOHandler::parseLeafModel(const std::string& text) {
+    const std::string name = toLower(text);
+    if (name == "flat") return LeafModel::FLAT;
+    if (name == "plane") return LeafModel::PLANE;
+    throw std::invalid_argument("Model leaf tidak dikenal: " + text + " (gunakan flat atau plane)");
+}
+
+void IOHandler::displayUsage(const std::string& programName) const {
+    std::cout << "Penggunaan:\n"
+              << "  " << programName << "                      (mode interaktif)\n"
+              << "  " << programName << " --input <file> --output <file> [opsi]\n"
+              << "  " << programName << " --batch <dir|daftar> --output-dir <dir> [opsi]\n"
+              << "  " << programName << " --serve <socket> [opsi]\n\n"
+              << "Opsi:\n"
+              << "  -i, --input <path>       Gambar input (.jpg, .jpeg, .png)\n"
+              << "  -o, --output <path>      Gambar hasil kompresi (.png, .jpg, .jpeg)\n"
+              << "  -m, --metric <nama>      variance | mad | max | entropy | ssim (atau 1-5), default variance\n"
+              << "  -t, --threshold <angka>  Ambang batas error, default 0\n"
+              << "  -b, --min-block <angka>  Ukuran minimum blok (luas piksel, >= 1), default 1\n"
+              << "  -r, --target <angka>     Target rasio kompresi (0 nonaktif, 0 <= target < 1)\n"
+              << "  -g, --gif <path>         Output GIF proses kompresi (opsional)\n"
+              << "  -j, --threads <angka>    Thread pembuatan GIF dan percobaan paralel mode target (0 = semua core)\n"
+              << "      --stats <format>     Format statistik: text (default), json, atau csv\n"
+              << "      --json               Sama dengan --stats json\n"
+              << "      --max-tree-memory <MB> Batas memori simpul pohon per gambar; minBlock diperbesar jika terlampaui\n"
+              << "      --build <mode>       depth (default, rekursif per threshold) | best (split error terbesar dulu)\n"
+              << "      --build rd           Pohon penuh dipangkas dengan biaya distorsi + lambda x rate\n"
+              << "      --split <mode>       quad (default, selalu 4 anak) | adaptive (pilih split 4, horizontal, atau vertikal)\n"
+              << "      --merge <mode>       none (default) | siblings (gabung anak leaf berwarna mirip ke induk)\n"
+              << "                           | regions (siblings + gabung leaf bertetangga menjadi persegi panjang)\n"
+              << "      --merge-tolerance <n> Selisih warna per channel yang masih digabung, 0-255 (default 0 = identik)\n"
+              << "      --leaf-model <model> flat (default, warna rata-rata) | plane (rata-rata + gradien x dan y;\n"
+              << "                           metrik variance, mad, max; tidak dengan --merge)\n"
+              << "      --max-leaves <n>     Batas jumlah leaf (menyiratkan --build best); 0 = tanpa batas\n"
+              << "      --lambda <angka>     Lambda pemangkasan --build rd (distorsi per bit), default 0\n"
+              << "      --min-psnr <dB>      Mode target kualitas: pohon terkecil dengan PSNR minimal ini (0 nonaktif)\n"
+              << "      --min-ssim <angka>   Mode target kualitas: pohon terkecil dengan SSIM minimal ini (0..1, 0 nonaktif)\n"
+              << "      --sweep <csv>        Tulis kurva threshold lengkap (node, leaf, PSNR, SSIM, ukuran) dari satu pohon\n"
+              << "      --sweep-encode <n>   Jumlah titik sweep yang di-encode sungguhan untuk kalibrasi ukuran (default 0)\n"
+              << "      --trace <path>       Tulis timeline proses sebagai Chrome trace JSON (chrome://tracing, Perfetto)\n\n"
+              << "Mode batch (menggantikan --input/--output):\n"
+              << "      --batch <path>       Direktori gambar atau file daftar (satu path per baris)\n"
+              << "      --output-dir <path>  Direktori hasil kompresi (nama file sama dengan input)\n"
+              << "      --report <path>      Laporan CSV gabungan (default <output-dir>/batch_report.csv)\n"
+              << "      --memory-budget <MB> Perkiraan memori maksimum gambar yang diproses bersamaan (default 1024)\n"
+              << "      (--threads menentukan jumlah gambar yang diproses paralel)\n"
+              << "\nMode server (Unix domain socket, opsi lain menjadi default tiap permintaan):\n"
+              << "      --serve <socket>     Jalankan sebagai server sampai SIGINT/SIGTERM\n"
+              << "      --max-pending <n>    Maks permintaan tertunda per koneksi (default 2 x thread)\n"
+              << "  -h, --help               Tampilkan bantuan ini\n";
+}
+
+bool IOHandler::parseArguments(int argc, char* argv[], CompressionOptions& options) {
+    bool thresholdGiven = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string flag = argv[i];
+        std::string value;
+        bool hasInlineValue = false;
+
+        // Mendukung bentuk --flag=nilai selain --flag nilai
+        size_t eq = flag.find('=');
+        if (flag.rfind("--", 0) == 0 && eq != std::string::npos) {
+            value = flag.substr(eq + 1);
+            flag = flag.substr(0, eq);
+            hasInlineValue = true;
+        }
+
+        auto nextValue = [&]() -> std::string {
+            if (hasInlineValue) {
+                return value;
+            }
+            if (i + 1 >= argc) {
+                throw std::invalid_argument("Opsi " + flag + " membutuhkan nilai.");
+            }
+            return argv[++i];
+        };
+
+        if (flag == "-h" || flag == "--help") {
+            displayUsage(argv[0]);
+            return false;
+        } else if (flag == "-i" || flag == "--input") {
+            options.inputPath = nextValue();
+        } else if (flag == "-o" || flag == "--output") {
+            options.outputPath = nextValue();
+        } else if (flag == "-m" || flag == "--metric") {
+            options.metric = parseMetric(nextValue());
+        } else if (flag == "-t" || flag == "--threshold") {
+            options.threshold = parseNumber<float>(flag, nextValue());
+            thresholdGiven = true;
+        } else if (flag == "-b" || flag == "--min-block") {
+            options.minBlockSize = parseNumber<int>(flag, nextValue());
+        } else if (flag == "-r" || flag == "--target") {
+            options.targetCompressionRatio = parseNumber<float>(flag, nextValue());
+        } else if (flag == "-g" || flag == "--gif") {
+            options.gifPath = nextValue();
+        } else if (flag == "-j" || flag == "--threads") {
+            int threads = parseNumber<int>(flag, nextValue());
+            if (threads < 0) {
+                throw std::invalid_argument("Jumlah thread tidak boleh negatif.");
+            }
+            options.threads = static_cast<unsigned>(threads);
+        } else if (flag == "--json") {
+            options.statsFormat = StatsFormat::JSON;
+        } else if (flag == "--stats") {
+            const std::string format = toLower(nextValue());
+            if (format == "text") {
+                options.statsFormat = StatsFormat::TEXT;
+            } else if (format == "json") {
+                options.statsFormat = StatsFormat::JSON;
+            } else if (format == "csv") {
+                options.statsFormat = StatsFormat::CSV;
+            } else {
+                throw std::invalid_argument("Format statistik tidak dikenal: " + format + " (gunakan text, json atau csv)");
+            }
+        } else if (flag == "--max-tree-memory") {
+            int megabytes = parseNumber<int>(flag, nextValue());
+            if (megabytes < 0) {
+                throw std::invalid_argument("Batas memori pohon tidak boleh negatif.");
+            }
+            options.maxTreeMemoryMB = static_cast<size_t>(megabytes);
+        } else if (flag == "--build") {
+            options.buildMode = parseBuildMode(nextValue());
+        } else if (flag == "--split") {
+            options.splitMode = parseSplitMode(nextValue());
+        } else if (flag == "--merge") {
+            options.mergeMode = parseMergeMode(nextValue());
+        } else if (flag == "--leaf-model") {
+            options.leafModel = parseLeafModel(nextValue());
+        } else if (flag == "--merge-tolerance") {
+            options.mergeTolerance = parseNumber<int>(flag, nextValue());
+            if (options.mergeTolerance < 0 || options.mergeTolerance > 255) {
+                throw std::invalid_argument("Toleransi penggabungan harus di antara 0 dan 255.");
+            }
+        } else if (flag == "--max-leaves") {
+            applyMaxLeaves(parseNumber<int>(flag, nextValue()), options);
+        } else if (flag == "--lambda") {
+            options.lambda = parseNumber<double>(flag, nextValue());
+            if (options.lambda < 0.0) {
+                throw std::invalid_argument("Lambda tidak boleh negatif.");
+            }
+        } else if (flag == "--min-psnr") {
+            applyMinPsnr(parseNumber<double>(flag, nextValue()), options);
+        } else if (flag == "--min-ssim") {
+            applyMinSsim(parseNumber<double>(flag, nextValue()), options);
+        } else if (flag == "--sweep") {
+            options.sweepPath = nextValue();
+        } else if (flag == "--sweep-encode") {
+            int count = parseNumber<int>(flag, nextValue());
+            if (count < 0) {
+                throw std::invalid_argument("Jumlah encode sweep tidak boleh negatif.");
+            }
+            options.sweepEncodeCount = static_cast<size_t>(count);
+        } else if (flag == "--trace") {
+            options.tracePath = nextValue();
+        } else if (flag == "--serve") {
+            options.serveSocket = nextValue();
+        } else if (flag == "--max-pending") {
+            int pending = parseNumber<int>(flag, nextValue());
+            if (pending < 1) {
+                throw std::invalid_argument("Nilai --max-pending minimal 1.");
+            }
+            options.maxPending = static_cast<size_t>(pending);
+        } else if (flag == "--batch") {
+            options.batchInput = nextValue();
+        } else if (flag == "--output-dir") {
+            options.outputDir = nextValue();
+        } else if (flag == "--report") {
+            options.reportPath = nextValue();
+        } else if (flag == "--memory-budget") {
+            int megabytes = parseNumber<int>(flag, nextValue());
+            if (megabytes < 1) {
+                throw std::invalid_argument("Anggaran memori minimal 1 MB.");
+            }
+            options.memoryBudgetMB = static_cast<size_t>(megabytes);
+        } else {
+            throw std::invalid_argument("Opsi tidak dikenal: " + flag + " (gunakan --help)");
+        }
+    }
+
+    // Validasi yang sama dengan mode interaktif, tetapi path relatif diperbolehkan
+    std::string error;
+    if (!options.serveSocket.empty()) {
+        // Parameter lain menjadi nilai default untuk setiap permintaan
+        if (!options.inputPath.empty() || !options.outputPath.empty() || !options.batchInput.empty()) {
+            throw std::invalid_argument("Opsi --serve tidak dapat digabung dengan --input/--output/--batch.");
+        }
+    } else if (!options.batchInput.empty()) {
+        // Path tiap gambar divalidasi per gambar oleh BatchRunner
+        if (!options.inputPath.empty() || !options.outputPath.empty()) {
+            throw std::invalid_argument("Opsi --batch tidak dapat digabung dengan --input/--output.");
+        }
+        if (options.outputDir.empty()) {
+            throw std::invalid_argument("Mode batch membutuhkan --output-dir.");
+        }
+    } else if (options.inputPath.empty()) {
+        throw std::invalid_argument("Opsi --input wajib diisi.");
+    }
+    if (!options.sweepPath.empty() && (!options.batchInput.empty() || !options.serveSocket.empty())) {
+        throw std::invalid_argument("Opsi --sweep hanya untuk satu gambar (--input).");
+    }
+    if (options.batchInput.empty() && options.serveSocket.empty()) {
+        if (!validateInputPath(options.inputPath, false, error)) {
+            throw std::invalid_argument(error);
+        }
+        // Mode sweep tidak menulis gambar; --output hanya menentukan format perkiraan ukuran
+        if (options.outputPath.empty() && options.sweepPath.empty()) {
+            throw std::invalid_argument("Opsi --output wajib diisi.");
+        }
+        if (!options.outputPath.empty() && !validateOutputPath(options.outputPath, false, error)) {
+            throw std::invalid_argument(error);
+        }
+    }
+    if (!options.sweepPath.empty() && !validateOutputLocation(fs::path(options.sweepPath), "sweep", error)) {
+        throw std::invalid_argument(error);
+    }
+    if (!options.gifPath.empty() && !validateGifOutputPath(options.gifPath, false, error)) {
+        throw std::invalid_argument(error);
+    }
+    if (thresholdGiven && !validateThreshold(options.metric, options.threshold, error)) {
+        throw std::invalid_argument(error);
+    }
+    if (!validateMinBlockSize(options.minBlockSize, error)) {
+        throw std::invalid_argument(error);
+    }
+    if (!validateTargetCompression(options.targetCompressionRatio, error)) {
+        throw std::invalid_argument(error);
+    }
+
+    selectedMetric = options.metric;
+    return true;
+}
+
 void IOHandler::displayStatistics(double execTime,
                                   double inputSizeKB,
                                   double compressedImageSizeKB,
                                   double finalOutputSizeKB,
                                   int depth,
-                                  size_t nodeCount) const {
+                                  size_t nodeCount,
+                                  double psnr,
+                                  double ssim) const {
     std::cout << std::fixed << std::setprecision(2);
     std::cout << "\n---------------- HASIL ---------------" << std::endl;
     std::cout << "8. Waktu Eksekusi       : " << execTime << " ms" << std::endl;
@@ -359,10 +709,256 @@ void IOHandler::displayStatistics(double execTime,
     } else {
             std::cout << "13. Jumlah Simpul Pohon  : N/A" << std::endl;
     }
+    if (psnr >= 0.0) {
+        std::cout << "14. PSNR                 : " << psnr << " dB" << std::endl;
+    }
+    if (ssim >= 0.0) {
+        std::cout << "15. SSIM                 : " << std::setprecision(4) << ssim << std::setprecision(2) << std::endl;
+    }
     std::cout << "--------------------------------------" << std::endl;
 }
 
+namespace {
+
+std::string jsonString(const std::string& s) {
+    // Path ditulis apa adanya kecuali karakter yang wajib di-escape di JSON
+    std::ostringstream out;
+    out << '"';
+    for (unsigned char c : s) {
+        if (c == '"' || c == '\\') {
+            out << '\\' << c;
+        } else if (c < 0x20) {
+            out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c) << std::dec;
+        } else {
+            out << c;
+        }
+    }
+    out << '"';
+    return out.str();
+}
+
+double compressionPercentOf(const CompressionResult& result) {
+    if (result.inputBytes == 0 || result.outputBytes == 0) {
+        return 0.0;
+    }
+    return (1.0 - static_cast<double>(result.outputBytes) / static_cast<double>(result.inputBytes)) * 100.0;
+}
+
+} // namespace
+
+std::string IOHandler::trim(const std::string& text) {
+    const char* whitespace = " \t\r\n";
+    size_t begin = text.find_first_not_of(whitespace);
+    if (begin == std::string::npos) {
+        return "";
+    }
+    size_t end = text.find_last_not_of(whitespace);
+    return text.substr(begin, end - begin + 1);
+}
+
+std::string IOHandler::csvString(const std::string& text) {
+    std::string out = "\"";
+    for (char c : text) {
+        if (c == '"') {
+            out += '"';
+        }
+        out += c;
+    }
+    return out + "\"";
+}
+
+std::string IOHandler::metricKey(ErrorMetric metric) {
+    switch (metric) {
+        case ErrorMetric::VARIANCE: return "variance";
+        case ErrorMetric::MAD: return "mad";
+        case ErrorMetric::MAX_PIXEL_DIFFERENCE: return "max";
+        case ErrorMetric::ENTROPY: return "entropy";
+        case ErrorMetric::SSIM: return "ssim";
+    }
+    return "unknown";
+}
+
+std::string IOHandler::buildModeKey(BuildMode mode) {
+    switch (mode) {
+        case BuildMode::DEPTH_FIRST: return "depth";
+        case BuildMode::BEST_FIRST: return "best";
+        case BuildMode::RATE_DISTORTION: return "rd";
+    }
+    return "unknown";
+}
+
+std::string IOHandler::splitModeKey(SplitMode mode) {
+    switch (mode) {
+        case SplitMode::QUAD: return "quad";
+        case SplitMode::ADAPTIVE: return "adaptive";
+    }
+    return "unknown";
+}
+
+std::string IOHandler::mergeModeKey(MergeMode mode) {
+    switch (mode) {
+        case MergeMode::NONE: return "none";
+        case MergeMode::SIBLINGS: return "siblings";
+        case MergeMode::REGIONS: return "regions";
+    }
+    return "unknown";
+}
+
+std::string IOHandler::leafModelKey(LeafModel model) {
+    switch (model) {
+        case LeafModel::FLAT: return "flat";
+        case LeafModel::PLANE: return "plane";
+    }
+    return "unknown";
+}
+
+void IOHandler::displayStatistics(const CompressionOptions& options, const CompressionResult& result) const {
+    switch (options.statsFormat) {
+        case StatsFormat::JSON:
+            std::cout << formatStatisticsJson(options, result) << std::endl;
+            break;
+        case StatsFormat::CSV:
+            std::cout << statisticsCsvHeader() << "\n" << formatStatisticsCsvRow(options, result) << std::endl;
+            break;
+        case StatsFormat::TEXT: {
+            double inputSizeKB = static_cast<double>(result.inputBytes) / 1024.0;
+            double compressedImageSizeKB = static_cast<double>(result.outputBytes) / 1024.0;
+            displayStatistics(result.execTimeMs, inputSizeKB, compressedImageSizeKB, compressedImageSizeKB,
+                              result.treeDepth, result.nodeCount, result.psnr, result.ssim);
+            break;
+        }
+    }
+}
+
+std::string IOHandler::formatStatisticsJson(const CompressionOptions& options, const CompressionResult& result) const {
+    std::ostringstream json;
+    json << std::setprecision(6);
+    json << "{"
+         << "\"input\":" << jsonString(options.inputPath) << ","
+         << "\"output\":" << jsonString(options.outputPath) << ","
+         << "\"gif\":" << (options.gifPath.empty() ? std::string("null") : jsonString(options.gifPath)) << ","
+         << "\"width\":" << result.imageWidth << ","
+         << "\"height\":" << result.imageHeight << ","
+         << "\"metric\":" << static_cast<int>(options.metric) + 1 << ","
+         << "\"metricName\":" << jsonString(metricKey(options.metric)) << ","
+         << "\"threshold\":" << options.threshold << ","
+         << "\"finalThreshold\":" << result.finalThreshold << ","
+         << "\"minBlockSize\":" << options.minBlockSize << ","
+         << "\"targetCompressionRatio\":" << options.targetCompressionRatio << ","
+         << "\"searchIterations\":" << result.searchIterations << ","
+         << "\"inputBytes\":" << result.inputBytes << ","
+         << "\"outputBytes\":" << result.outputBytes << ","
+         << "\"compressionPercent\":" << compressionPercentOf(result) << ","
+         << "\"treeDepth\":" << result.treeDepth << ","
+         << "\"nodeCount\":" << result.nodeCount << ","
+         << "\"leafCount\":" << result.leafCount << ","
+         << "\"leafDepthHistogram\":[";
+    for (size_t i = 0; i < result.leafDepthHistogram.size(); ++i) {
+        json << (i ? "," : "") << result.leafDepthHistogram[i];
+    }
+    json << "],"
+         << "\"timingsMs\":{"
+         << "\"load\":" << result.phases.loadMs << ","
+         << "\"search\":" << result.phases.searchMs << ","
+         << "\"build\":" << result.phases.buildMs << ","
+         << "\"reconstruct\":" << result.phases.reconstructMs << ","
+         << "\"encode\":" << result.phases.encodeMs << ","
+         << "\"gif\":" << result.phases.gifMs << ","
+         << "\"total\":" << result.phases.total() << "},"
+         << "\"execTimeMs\":" << result.execTimeMs << ","
+         << "\"peakRssKB\":" << result.peakRssKB << ","
+         << "\"treeBytes\":" << result.treeBytes << ","
+         << "\"effectiveMinBlockSize\":" << result.effectiveMinBlockSize << ","
+         << "\"buildMode\":" << jsonString(buildModeKey(options.buildMode)) << ","
+         << "\"maxLeaves\":" << options.maxLeaves << ","
+         << "\"finalMaxLeaves\":" << result.finalMaxLeaves << ","
+         << "\"lambda\":" << result.finalLambda << ","
+         << "\"rateBits\":" << result.rateBits << ","
+         << "\"searchEncodes\":" << result.searchEncodes << ","
+         << "\"searchRounds\":" << result.searchRounds << ","
+         << "\"minPsnr\":" << options.minPsnr << ","
+         << "\"minSsim\":" << options.minSsim << ","
+         << "\"qualityFloorMet\":" << (result.qualityFloorMet ? "true" : "false") << ","
+         << "\"psnr\":" << result.psnr << ","
+         << "\"ssim\":" << result.ssim << ","
+         << "\"splitMode\":" << jsonString(splitModeKey(options.splitMode)) << ","
+         << "\"mergeMode\":" << jsonString(mergeModeKey(options.mergeMode)) << ","
+         << "\"mergeTolerance\":" << options.mergeTolerance << ","
+         << "\"regionCount\":" << result.regionCount << ","
+         << "\"leafModel\":" << jsonString(leafModelKey(options.leafModel))
+         << "}";
+    return json.str();
+}
+
+std::string IOHandler::statisticsCsvHeader() {
+    return "input,output,gif,width,height,metric,threshold,final_threshold,min_block_size,target_compression_ratio,"
+           "search_iterations,input_bytes,output_bytes,compression_percent,tree_depth,node_count,leaf_count,"
+           "leaf_depth_histogram,load_ms,search_ms,build_ms,reconstruct_ms,encode_ms,gif_ms,total_ms,exec_time_ms,peak_rss_kb,"
+           "tree_bytes,effective_min_block_size,build_mode,max_leaves,final_max_leaves,lambda,rate_bits,search_encodes,search_rounds,"
+           "min_psnr,min_ssim,psnr,ssim,split_mode,merge_mode,merge_tolerance,region_count,leaf_model";
+}
+
+std::string IOHandler::formatStatisticsCsvRow(const CompressionOptions& options, const CompressionResult& result) const {
+    // Histogram ditulis sebagai satu kolom "a;b;c" agar jumlah kolom tetap sama untuk semua baris
+    std::string histogram;
+    for (size_t i = 0; i < result.leafDepthHistogram.size(); ++i) {
+        histogram += (i ? ";" : "") + std::to_string(result.leafDepthHistogram[i]);
+    }
+
+    std::ostringstream csv;
+    csv << std::setprecision(6);
+    csv << csvString(options.inputPath) << ","
+        << csvString(options.outputPath) << ","
+        << csvString(options.gifPath) << ","
+        << result.imageWidth << ","
+        << result.imageHeight << ","
+        << metricKey(options.metric) << ","
+        << options.threshold << ","
+        << result.finalThreshold << ","
+        << options.minBlockSize << ","
+        << options.targetCompressionRatio << ","
+        << result.searchIterations << ","
+        << result.inputBytes << ","
+        << result.outputBytes << ","
+        << compressionPercentOf(result) << ","
+        << result.treeDepth << ","
+        << result.nodeCount << ","
+        << result.leafCount << ","
+        << histogram << ","
+        << result.phases.loadMs << ","
+        << result.phases.searchMs << ","
+        << result.phases.buildMs << ","
+        << result.phases.reconstructMs << ","
+        << result.phases.encodeMs << ","
+        << result.phases.gifMs << ","
+        << result.phases.total() << ","
+        << result.execTimeMs << ","
+        << result.peakRssKB << ","
+        << result.treeBytes << ","
+        << result.effectiveMinBlockSize << ","
+        << buildModeKey(options.buildMode) << ","
+        << options.maxLeaves << ","
+        << result.finalMaxLeaves << ","
+        << result.finalLambda << ","
+        << result.rateBits << ","
+        << result.searchEncodes << ","
+        << result.searchRounds << ","
+        << options.minPsnr << ","
+        << options.minSsim << ","
+        << result.psnr << ","
+        << result.ssim << ","
+        << splitModeKey(options.splitMode) << ","
+        << mergeModeKey(options.mergeMode) << ","
+        << options.mergeTolerance << ","
+        << result.regionCount << ","
+        << leafModelKey(options.leafModel);
+    return csv.str();
+}
+
 void IOHandler::displayMessage(const std::string& message) const {
+    if (quiet) {
+        return;
+    }
     std::cout << "[INFO] " << message << std::endl;
 }
 
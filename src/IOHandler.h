@@ -4,12 +4,14 @@
 #include <string>
 #include <filesystem>
 #include "QuadTree.h"
+#include "CompressionOptions.h"
 
 namespace fs = std::filesystem;
 
 class IOHandler {
 private:
-    ErrorMetric selectedMetric; 
+    ErrorMetric selectedMetric = ErrorMetric::VARIANCE;
+    bool quiet = false;
     void clearInputBuffer() const;
 
 public:
@@ -21,15 +23,66 @@ public:
     int promptForMinBlockSize();
     float promptForTargetCompressionPercentage();
 
+    // Validasi yang dipakai bersama oleh prompt interaktif dan argumen command line.
+    // Mengembalikan false dan mengisi error jika nilai tidak valid.
+    bool validateInputPath(const std::string& filePath, bool requireAbsolute, std::string& error) const;
+    bool validateOutputPath(const std::string& filePath, bool requireAbsolute, std::string& error) const;
+    bool validateGifOutputPath(const std::string& filePath, bool requireAbsolute, std::string& error) const;
+    bool validateThreshold(ErrorMetric metric, float value, std::string& error) const;
+    bool validateMinBlockSize(int value, std::string& error) const;
+    bool validateTargetCompression(float value, std::string& error) const;
+    static void getThresholdRange(ErrorMetric metric, std::string& metricName, float& minVal, float& maxVal);
+
+    // Mengisi options dari argumen command line. Mengembalikan false jika program cukup
+    // menampilkan bantuan; argumen tidak valid dilempar sebagai std::invalid_argument.
+    bool parseArguments(int argc, char* argv[], CompressionOptions& options);
+    void displayUsage(const std::string& programName) const;
+
+    // Parser nilai yang dipakai bersama oleh argumen command line dan permintaan mode server;
+    // nilai tidak valid dilempar sebagai std::invalid_argument
+    static ErrorMetric parseMetric(const std::string& text);
+    static BuildMode parseBuildMode(const std::string& text);
+    static SplitMode parseSplitMode(const std::string& text);
+    static MergeMode parseMergeMode(const std::string& text);
+    static LeafModel parseLeafModel(const std::string& text);
+    static float parseFloat(const std::string& name, const std::string& text);
+    static int parseInt(const std::string& name, const std::string& text);
+    // Batas leaf > 0 menyiratkan BEST_FIRST; negatif dilempar sebagai std::invalid_argument
+    static void applyMaxLeaves(int leaves, CompressionOptions& options);
+    // Batas mode target kualitas; di luar rentang (PSNR < 0, SSIM di luar 0..1) dilempar
+    // sebagai std::invalid_argument
+    static void applyMinPsnr(double psnr, CompressionOptions& options);
+    static void applyMinSsim(double ssim, CompressionOptions& options);
+
     void displayStatistics(double execTime,
                            double inputSizeKB,
                            double compressedImageSizeKB,
                            double finalOutputSizeKB,
                            int depth = -1,
-                           size_t nodeCount = 0) const;
+                           size_t nodeCount = 0,
+                           double psnr = -1.0,
+                           double ssim = -1.0) const;
+    // Menampilkan statistik sesuai options.statsFormat (teks, JSON satu baris, atau CSV header + baris)
+    void displayStatistics(const CompressionOptions& options, const CompressionResult& result) const;
+    std::string formatStatisticsJson(const CompressionOptions& options, const CompressionResult& result) const;
+    static std::string statisticsCsvHeader();
+    std::string formatStatisticsCsvRow(const CompressionOptions& options, const CompressionResult& result) const;
+    static std::string metricKey(ErrorMetric metric);
+    static std::string buildModeKey(BuildMode mode);
+    static std::string splitModeKey(SplitMode mode);
+    static std::string mergeModeKey(MergeMode mode);
+    static std::string leafModelKey(LeafModel model);
+
+    // Helper string yang dipakai bersama oleh mode batch dan server
+    static std::string trim(const std::string& text);  // buang spasi, tab dan akhir baris di kedua ujung
+    static std::string toLower(std::string text);
+    static std::string csvString(const std::string& text); // field CSV berkutip, kutip di dalamnya digandakan
+
+    // Mode quiet menyembunyikan pesan [INFO] (misalnya saat stdout dipakai untuk JSON/CSV)
+    void setQuiet(bool value) { quiet = value; }
 
     void displayMessage(const std::string& message) const;
     void displayError(const std::string& errorMessage) const;
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -1,4 +1,5 @@
 #include "Image.h"
+#include "Instrumentation.h"
 
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
@@ -10,6 +11,7 @@
 #include <memory>  
 #include <algorithm>
 #include <cctype>   
+#include <limits>
 using namespace std;
 
 // Implementasi konstruktor
@@ -31,6 +33,7 @@ Image Image::loadFromFile(const std::string& filePath) {
 
 // Implementasi loadImage
 void Image::loadImage(const std::string& filePath) {
+    QT_SCOPED_TIMER(IMAGE_LOAD, 0);
     int w, h, channels_in_file;
 
     auto deleter = [](unsigned char* data){ stbi_image_free(data); };
@@ -42,26 +45,55 @@ void Image::loadImage(const std::string& filePath) {
     if (rawData == nullptr) {
         throw ImageError("Error loading image '" + filePath + "': " + stbi_failure_reason());
     }
+    QT_COUNT_PIXELS(IMAGE_LOAD, static_cast<long long>(w) * h);
 
+    assignRaw(rawData.get(), w, h);
+}
+
+Image Image::loadFromMemory(const unsigned char* data, std::size_t size) {
+    if (size > static_cast<std::size_t>(std::numeric_limits<int>::max())) {
+        throw ImageError("Encoded image is too large.");
+    }
+
+    QT_SCOPED_TIMER(IMAGE_LOAD, 0);
+    int w, h, channels_in_file;
+    auto deleter = [](unsigned char* raw){ stbi_image_free(raw); };
+    std::unique_ptr<unsigned char, decltype(deleter)> rawData(
+        stbi_load_from_memory(data, static_cast<int>(size), &w, &h, &channels_in_file, NumChannels),
+        deleter
+    );
+
+    if (rawData == nullptr) {
+        throw ImageError(std::string("Error decoding image from memory: ") + stbi_failure_reason());
+    }
+    QT_COUNT_PIXELS(IMAGE_LOAD, static_cast<long long>(w) * h);
+
+    Image img;
+    img.assignRaw(rawData.get(), w, h);
+    return img;
+}
+
+void Image::assignRaw(const unsigned char* rawData, int w, int h) {
     width = w;
     height = h;
     std::size_t totalPixels = static_cast<std::size_t>(width) * height;
     pixels.resize(totalPixels);
 
-    const unsigned char* currentPixelData = rawData.get();
+    const unsigned char* currentPixelData = rawData;
     for (std::size_t i = 0; i < totalPixels; ++i) {
         pixels[i].r = currentPixelData[0];
         pixels[i].g = currentPixelData[1];
         pixels[i].b = currentPixelData[2];
         currentPixelData += NumChannels;
     }
-
 }
 
 void Image::saveImage(const std::string& filePath, int jpgQuality) const {
     if (isEmpty()) {
         throw ImageError("Cannot save empty image.");
     }
+    QT_SCOPED_TIMER(IMAGE_SAVE, pixels.size());
+    QT_COUNT_ALLOC(IMAGE_SAVE, 1);
 
     std::vector<unsigned char> rawOutputData(pixels.size() * NumChannels);
     for (std::size_t i = 0; i < pixels.size(); ++i) {
@@ -100,6 +132,56 @@ void Image::saveImage(const std::string& filePath, int jpgQuality) const {
     }
 }
 
+namespace {
+
+void appendToVector(void* context, void* data, int size) {
+    auto* out = static_cast<std::vector<unsigned char>*>(context);
+    auto* bytes = static_cast<unsigned char*>(data);
+    out->insert(out->end(), bytes, bytes + size);
+}
+
+} // namespace
+
+std::vector<unsigned char> Image::encodeToMemory(const std::string& extension, int jpgQuality) const {
+    if (isEmpty()) {
+        throw ImageError("Cannot encode empty image.");
+    }
+    QT_SCOPED_TIMER(IMAGE_ENCODE, pixels.size());
+
+    std::string ext = extension;
+    std::transform(ext.begin(), ext.end(), ext.begin(),
+                   [](unsigned char c){ return std::tolower(c); });
+
+    // Pixel berisi tiga byte r, g, b berurutan sehingga data piksel bisa langsung diberikan ke stb
+    static_assert(sizeof(Pixel) == NumChannels, "Pixel harus tersusun rapat (RGB 8-bit)");
+    const unsigned char* raw = reinterpret_cast<const unsigned char*>(pixels.data());
+
+    std::vector<unsigned char> out;
+    int success = 0;
+    if (ext == ".png") {
+        success = stbi_write_png_to_func(appendToVector, &out, width, height, NumChannels, raw, width * NumChannels);
+    } else if (ext == ".bmp") {
+        success = stbi_write_bmp_to_func(appendToVector, &out, width, height, NumChannels, raw);
+    } else if (ext == ".jpg" || ext == ".jpeg") {
+        if (jpgQuality < 1) jpgQuality = 1;
+        if (jpgQuality > 100) jpgQuality = 100;
+        success = stbi_write_jpg_to_func(appendToVector, &out, width, height, NumChannels, raw, jpgQuality);
+    } else if (ext == ".tga") {
+        success = stbi_write_tga_to_func(appendToVector, &out, width, height, NumChannels, raw);
+    } else {
+        throw ImageError("Unsupported file extension '" + ext + "' for encoding. Use .png, .bmp, .jpg, or .tga.");
+    }
+
+    if (success == 0) {
+        throw ImageError("Failed to encode image as '" + ext + "'.");
+    }
+    return out;
+}
+
+bool Image::readInfo(const std::string& filePath, int& w, int& h, int& channels) {
+    return stbi_info(filePath.c_str(), &w, &h, &channels) != 0;
+}
+
 bool Image::checkBounds(int i, int j) const noexcept {
      return i < height && i >= 0 && j < width && j >= 0;
 }
@@ -111,6 +193,7 @@ std::size_t Image::getIndex(int i, int j) const {
 
 // Implementasi getPixel
 Pixel Image::getPixel(int i, int j) const {
+    QT_COUNT_CALL(PIXEL_ACCESS);
     if (!checkBounds(i, j)) {
         throw std::out_of_range("Pixel coordinates (" + std::to_string(j) + ", " + std::to_string(i) + ") are out of bounds ["+ std::to_string(width) + "i" + std::to_string(height) +"].");
     }
@@ -119,6 +202,7 @@ Pixel Image::getPixel(int i, int j) const {
 
 // Implementasi setPixel
 void Image::setPixel(int i, int j, const Pixel& p) {
+    QT_COUNT_CALL(PIXEL_ACCESS);
     if (!checkBounds(i, j)) {
         throw std::out_of_range("Pixel coordinates (" + std::to_string(j) + ", " + std::to_string(i) + ") are out of bounds ["+ std::to_string(width) + "i" + std::to_string(height) +"].");
     }
@@ -28,6 +28,8 @@ private:
     bool checkBounds(int i, int j) const noexcept;
     // Helper untuk menghitung indeks 1D (juga tidak perlu publik)
     std::size_t getIndex(int i, int j) const;
+    // Menyalin data RGB 8-bit hasil decode stb ke pixels
+    void assignRaw(const unsigned char* rawData, int w, int h);
 
 public:
     static constexpr int NumChannels = 3;
@@ -38,10 +40,19 @@ public:
 
     static Image loadFromFile(const std::string& filePath);
 
+    // Men-decode gambar (.png, .jpg, ...) yang sudah ada di memori
+    static Image loadFromMemory(const unsigned char* data, std::size_t size);
+
     void loadImage(const std::string& filePath);
 
     void saveImage(const std::string& filePath, int jpgQuality = 85) const;
 
+    // Meng-encode gambar ke memori dengan format sesuai ekstensi (".png", ".jpg", ...)
+    std::vector<unsigned char> encodeToMemory(const std::string& extension, int jpgQuality = 85) const;
+
+    // Membaca ukuran gambar dari header file tanpa men-decode pikselnya
+    static bool readInfo(const std::string& filePath, int& w, int& h, int& channels);
+
     Pixel getPixel(int i, int j) const;
 
     void setPixel(int i, int j, const Pixel& p);
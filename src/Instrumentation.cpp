@@ -0,0 +1,125 @@
+#include "Instrumentation.h"
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Semua blok counter yang pernah dibuat. Blok disimpan sebagai shared_ptr sehingga
+// datanya tetap ada setelah thread pemiliknya selesai (misalnya worker ThreadPool).
+class Registry {
+public:
+    std::mutex mutex;
+    std::vector<std::shared_ptr<Instrumentation::ThreadStats>> threads;
+
+    // Ringkasan ditulis ketika registry dihancurkan saat program selesai
+    ~Registry() {
+        const char* path = std::getenv("QT_INSTRUMENT_FILE");
+        if (path && *path) {
+            std::ofstream file(path);
+            if (file) {
+                Instrumentation::dump(file);
+                return;
+            }
+        }
+        Instrumentation::dump(std::cerr);
+    }
+};
+
+Registry& registry() {
+    static Registry instance;
+    return instance;
+}
+
+void writeRow(std::ostream& out, const std::string& thread, Instrumentation::Counter counter,
+              const Instrumentation::Stats& s) {
+    const double ms = static_cast<double>(s.nanoseconds) / 1e6;
+    const double nsPerCall = s.calls ? static_cast<double>(s.nanoseconds) / static_cast<double>(s.calls) : 0.0;
+    out << std::left << std::setw(10) << thread << std::setw(17) << Instrumentation::name(counter)
+        << std::right << std::setw(14) << s.calls << std::setw(16) << s.pixels
+        << std::fixed << std::setprecision(3) << std::setw(13) << ms
+        << std::setprecision(1) << std::setw(12) << nsPerCall << std::defaultfloat
+        << std::setw(12) << s.allocations << "\n";
+}
+
+} // namespace
+
+Instrumentation::ThreadStats& Instrumentation::local() {
+    thread_local std::shared_ptr<ThreadStats> stats = [] {
+        auto block = std::make_shared<ThreadStats>();
+        Registry& reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        reg.threads.push_back(block);
+        return block;
+    }();
+    return *stats;
+}
+
+const char* Instrumentation::name(Counter counter) {
+    switch (counter) {
+        case Counter::BUILD_NODE: return "build_node";
+        case Counter::NODE_ALLOC: return "node_alloc";
+        case Counter::AVERAGE_COLOR: return "average_color";
+        case Counter::METRIC_VARIANCE: return "metric_variance";
+        case Counter::METRIC_MAD: return "metric_mad";
+        case Counter::METRIC_MAX: return "metric_max";
+        case Counter::METRIC_ENTROPY: return "metric_entropy";
+        case Counter::METRIC_SSIM: return "metric_ssim";
+        case Counter::PIXEL_ACCESS: return "pixel_access";
+        case Counter::RECONSTRUCT: return "reconstruct";
+        case Counter::IMAGE_LOAD: return "image_load";
+        case Counter::IMAGE_SAVE: return "image_save";
+        case Counter::IMAGE_ENCODE: return "image_encode";
+        case Counter::GIF_RENDER: return "gif_render";
+        case Counter::GIF_ENCODE: return "gif_encode";
+        case Counter::GIF_WRITE: return "gif_write";
+        case Counter::COUNT: break;
+    }
+    return "unknown";
+}
+
+// Dipanggil setelah thread pekerja selesai; counter dibaca tanpa sinkronisasi tambahan
+void Instrumentation::dump(std::ostream& out) {
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+
+    out << "\n[INSTRUMENT] counter per thread (waktu inklusif; timer bersarang dihitung di keduanya)\n";
+    out << std::left << std::setw(10) << "thread" << std::setw(17) << "counter"
+        << std::right << std::setw(14) << "calls" << std::setw(16) << "pixels"
+        << std::setw(13) << "ms" << std::setw(12) << "ns/call" << std::setw(12) << "allocs" << "\n";
+
+    ThreadStats total{};
+    for (size_t t = 0; t < reg.threads.size(); ++t) {
+        const ThreadStats& stats = *reg.threads[t];
+        for (size_t c = 0; c < stats.size(); ++c) {
+            const Stats& s = stats[c];
+            if (s.calls == 0 && s.pixels == 0 && s.allocations == 0) {
+                continue;
+            }
+            writeRow(out, "#" + std::to_string(t), static_cast<Counter>(c), s);
+            total[c].calls += s.calls;
+            total[c].pixels += s.pixels;
+            total[c].nanoseconds += s.nanoseconds;
+            total[c].allocations += s.allocations;
+        }
+    }
+    for (size_t c = 0; c < total.size(); ++c) {
+        if (total[c].calls > 0 || total[c].pixels > 0 || total[c].allocations > 0) {
+            writeRow(out, "total", static_cast<Counter>(c), total[c]);
+        }
+    }
+    out.flush();
+}
+
+void Instrumentation::reset() {
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    for (auto& stats : reg.threads) {
+        stats->fill(Stats{});
+    }
+}
@@ -0,0 +1,99 @@
+#ifndef INSTRUMENTATION_H
+#define INSTRUMENTATION_H
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+// Counter dan timer ringan untuk jalur panas (build pohon, kernel metrik, rekonstruksi,
+// load/save gambar, tahap GIF). Hanya aktif jika dikompilasi dengan -DQT_INSTRUMENT
+// (opsi CMake QT_INSTRUMENT=ON); tanpa flag itu semua makro QT_* di bawah menjadi kosong.
+//
+// Setiap thread menulis ke blok counter miliknya sendiri tanpa lock. Ringkasan per thread
+// dan totalnya ditulis ke stderr saat program selesai, atau ke file yang ditunjuk oleh
+// variabel lingkungan QT_INSTRUMENT_FILE.
+class Instrumentation {
+public:
+    enum class Counter {
+        BUILD_NODE,       // panggilan buildRecursive (satu per simpul)
+        NODE_ALLOC,       // pembuatan simpul anak, termasuk warna rata-ratanya
+        AVERAGE_COLOR,    // calculateAverageColor
+        METRIC_VARIANCE,
+        METRIC_MAD,
+        METRIC_MAX,
+        METRIC_ENTROPY,
+        METRIC_SSIM,
+        PIXEL_ACCESS,     // getPixel/setPixel dengan pemeriksaan batas (hanya jumlah panggilan)
+        RECONSTRUCT,      // pengisian leaf pada reconstructRegion
+        IMAGE_LOAD,
+        IMAGE_SAVE,
+        IMAGE_ENCODE,     // encodeToMemory
+        GIF_RENDER,       // render frame + konversi ke RGBA
+        GIF_ENCODE,       // kuantisasi + LZW satu frame
+        GIF_WRITE,        // penulisan frame yang sudah di-encode ke sink
+        COUNT
+    };
+
+    struct Stats {
+        uint64_t calls = 0;
+        uint64_t pixels = 0;
+        uint64_t nanoseconds = 0;
+        uint64_t allocations = 0;
+    };
+
+    using ThreadStats = std::array<Stats, static_cast<size_t>(Counter::COUNT)>;
+
+    // Blok counter milik thread pemanggil (didaftarkan saat pertama kali dipakai)
+    static ThreadStats& local();
+
+    static Stats& at(Counter counter) { return local()[static_cast<size_t>(counter)]; }
+
+    static const char* name(Counter counter);
+
+    // Menulis ringkasan per thread dan total ke out
+    static void dump(std::ostream& out);
+
+    // Mengosongkan semua counter (misalnya di antara putaran benchmark)
+    static void reset();
+
+    class ScopedTimer {
+    private:
+        Stats& stats;
+        std::chrono::steady_clock::time_point start;
+
+    public:
+        ScopedTimer(Counter counter, uint64_t pixels)
+            : stats(at(counter)), start(std::chrono::steady_clock::now()) {
+            stats.calls++;
+            stats.pixels += pixels;
+        }
+        ~ScopedTimer() {
+            stats.nanoseconds += static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start).count());
+        }
+        ScopedTimer(const ScopedTimer&) = delete;
+        ScopedTimer& operator=(const ScopedTimer&) = delete;
+    };
+};
+
+#ifdef QT_INSTRUMENT
+#define QT_INSTRUMENT_CONCAT_IMPL(a, b) a##b
+#define QT_INSTRUMENT_CONCAT(a, b) QT_INSTRUMENT_CONCAT_IMPL(a, b)
+// Mengukur waktu sampai akhir scope dan menambah jumlah panggilan serta piksel yang disentuh
+#define QT_SCOPED_TIMER(counter, pixels) \
+    Instrumentation::ScopedTimer QT_INSTRUMENT_CONCAT(qtScopedTimer_, __LINE__)( \
+        Instrumentation::Counter::counter, static_cast<uint64_t>(pixels))
+#define QT_COUNT_CALL(counter) (Instrumentation::at(Instrumentation::Counter::counter).calls++)
+#define QT_COUNT_PIXELS(counter, n) \
+    (Instrumentation::at(Instrumentation::Counter::counter).pixels += static_cast<uint64_t>(n))
+#define QT_COUNT_ALLOC(counter, n) \
+    (Instrumentation::at(Instrumentation::Counter::counter).allocations += static_cast<uint64_t>(n))
+#else
+#define QT_SCOPED_TIMER(counter, pixels) ((void)0)
+#define QT_COUNT_CALL(counter) ((void)0)
+#define QT_COUNT_PIXELS(counter, n) ((void)0)
+#define QT_COUNT_ALLOC(counter, n) ((void)0)
+#endif
+
+#endif // INSTRUMENTATION_H
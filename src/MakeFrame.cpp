@@ -1,14 +1,17 @@
 #include "MakeFrame.h"
+#include "Instrumentation.h"
 #include <iostream>
 #include <filesystem>
 #include <sstream>
 #include <iomanip>
+#include <algorithm>
+#include <stdexcept>
 
 namespace fs = std::filesystem;
 
 // Fungsi untuk membuat frame berdasarkan threshold dan minBlock yang meningkat
 void MakeFrame::createFrames(const std::string& inputImagePath, const std::string& outputFolderPath,
-                              float threshold, int minBlockSize, int frameCount) {
+                              float threshold, int minBlockSize, int frameCount, ErrorMetric metric) {
     // Memuat gambar asli
     Image inputImage = Image::loadFromFile(inputImagePath);
 
@@ -40,19 +43,16 @@ void MakeFrame::createFrames(const std::string& inputImagePath, const std::strin
      }
 
 
-    // Menghitung peningkatan progres untuk threshold dan minBlock
-    float thresholdStep = (threshold > 0) ? (threshold / frameCount ) : 1;
-    int minBlockStep = (minBlockSize > 0) ? (minBlockSize / frameCount) : 1;
+    GifSchedule schedule;
+    schedule.mode = GifSchedule::Mode::THRESHOLD_RAMP;
+    schedule.metric = metric;
+    schedule.threshold = threshold;
+    schedule.minBlockSize = minBlockSize;
+    schedule.frameCount = frameCount;
 
     // Membuat setiap frame
     for (int i = 0; i < frameCount; ++i) {  // Mulai dari frame_1, karena frame_0 adalah gambar original
-        // Menentukan threshold dan minBlock untuk frame ini
-        float currentThreshold = thresholdStep * (i + 1);
-        int currentMinBlockSize = minBlockStep * (i + 1);
-
-        // Proses kompresi gambar dengan nilai threshold dan minBlock yang berbeda-beda
-        Quadtree qt(inputImage, ErrorMetric::VARIANCE, currentThreshold, currentMinBlockSize);
-        Image resultImage = qt.reconstructImage();
+        Image resultImage = renderFrame(inputImage, nullptr, schedule, i + 1);
 
         // Simpan frame
         saveFrame(resultImage, outputFolderPath, i+1);
@@ -61,6 +61,64 @@ void MakeFrame::createFrames(const std::string& inputImagePath, const std::strin
     
 }
 
+GifSchedule GifSchedule::fromTree(const Quadtree& tree, ErrorMetric metric, float threshold, int minBlockSize) {
+    GifSchedule schedule;
+    schedule.mode = Mode::DEPTH;
+    schedule.metric = metric;
+    schedule.threshold = threshold;
+    schedule.minBlockSize = minBlockSize;
+    schedule.frameCount = std::max(1, tree.getDepth());
+    schedule.includeOriginal = false;
+    schedule.frameDelay = 50;
+    schedule.lastFrameDelay = 200;
+    return schedule;
+}
+
+int GifSchedule::totalFrames() const {
+    return std::max(1, frameCount) + (includeOriginal ? 1 : 0);
+}
+
+uint32_t GifSchedule::delayFor(int frameIndex) const {
+    return (frameIndex == totalFrames() - 1) ? lastFrameDelay : frameDelay;
+}
+
+// Fungsi untuk membuat frame ke-frameIndex langsung di memori tanpa menyimpan ke disk
+Image MakeFrame::renderFrame(const Image& inputImage, const Quadtree* finalTree,
+                             const GifSchedule& schedule, int frameIndex) {
+    QT_SCOPED_TIMER(GIF_RENDER, inputImage.getPixelCount());
+    if (schedule.includeOriginal) {
+        if (frameIndex == 0) {
+            return inputImage;
+        }
+    } else {
+        ++frameIndex; // tanpa original, frame 0 sudah merupakan langkah pertama
+    }
+
+    const int frameCount = std::max(1, schedule.frameCount);
+
+    if (schedule.mode == GifSchedule::Mode::DEPTH) {
+        if (!finalTree) {
+            throw std::invalid_argument("Mode frame DEPTH membutuhkan pohon final.");
+        }
+        // Langkah ke-k dipetakan ke kedalaman ceil(k * depth / frameCount)
+        const int depth = std::max(1, finalTree->getDepth());
+        int frameDepth = (frameIndex * depth + frameCount - 1) / frameCount;
+        return finalTree->reconstructImage(std::clamp(frameDepth, 1, depth));
+    }
+
+    // Menghitung peningkatan progres untuk threshold dan minBlock
+    float thresholdStep = (schedule.threshold > 0) ? (schedule.threshold / frameCount ) : 1;
+    int minBlockStep = (schedule.minBlockSize > 0) ? (schedule.minBlockSize / frameCount) : 1;
+
+    // Menentukan threshold dan minBlock untuk frame ini
+    float currentThreshold = thresholdStep * frameIndex;
+    int currentMinBlockSize = minBlockStep * frameIndex;
+
+    // Proses kompresi gambar dengan nilai threshold dan minBlock yang berbeda-beda
+    Quadtree qt(inputImage, schedule.metric, currentThreshold, currentMinBlockSize);
+    return qt.reconstructImage();
+}
+
 // Fungsi untuk menyimpan frame sebagai file gambar
 void MakeFrame::saveFrame(const Image& img, const std::string& outputPath, int frameIndex) {
     std::stringstream frameName;
@@ -2,20 +2,50 @@
 #define MAKEFRAME_H
 
 #include <string>
+#include <cstdint>
 #include "Image.h"
 #include "QuadTree.h"
 // #include "ErrorMetric.h"
 
+// Jadwal animasi GIF: bagaimana tiap frame dibuat dan berapa lama ditampilkan
+struct GifSchedule {
+    enum class Mode {
+        DEPTH,          // frame ke-k = pohon final yang dipotong pada kedalaman k
+        THRESHOLD_RAMP  // frame ke-k = pohon baru dengan threshold dan minBlock yang naik bertahap
+    };
+
+    Mode mode = Mode::THRESHOLD_RAMP;
+    ErrorMetric metric = ErrorMetric::VARIANCE;
+    float threshold = 0.0f;
+    int minBlockSize = 1;
+    int frameCount = 10;            // jumlah frame hasil kompresi (tidak termasuk original)
+    bool includeOriginal = true;    // frame 0 adalah gambar sumber
+    uint32_t frameDelay = 50;       // dalam seperseratus detik
+    uint32_t lastFrameDelay = 50;   // lama frame terakhir ditahan
+    int loopCount = 0;              // 0 = ulang terus
+
+    // Satu frame per level pohon final, diakhiri dengan hasil kompresi yang ditahan lebih lama
+    static GifSchedule fromTree(const Quadtree& tree, ErrorMetric metric, float threshold, int minBlockSize);
+
+    int totalFrames() const;
+    uint32_t delayFor(int frameIndex) const;
+};
+
 class MakeFrame {
 public:
     // Fungsi untuk membuat frame berdasarkan progress threshold dan minBlock
     static void createFrames(const std::string& inputImagePath, const std::string& outputFolderPath,
-                             float threshold, int minBlockSize, int frameCount);
+                             float threshold, int minBlockSize, int frameCount,
+                             ErrorMetric metric = ErrorMetric::VARIANCE);
     static void deleteFramesFolder(const std::string& folderPath);
+    // Membuat frame ke-frameIndex dari jadwal di memori.
+    // finalTree wajib ada untuk mode DEPTH dan tidak dipakai untuk THRESHOLD_RAMP.
+    static Image renderFrame(const Image& inputImage, const Quadtree* finalTree,
+                             const GifSchedule& schedule, int frameIndex);
 private:
     // Fungsi untuk menyimpan gambar sebagai frame di folder yang ditentukan
     static void saveFrame(const Image& img, const std::string& outputPath, int frameIndex);
-    
+
 };
 
 #endif // MAKEFRAME_H
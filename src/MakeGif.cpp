@@ -4,11 +4,147 @@
 #include <string>
 #include <filesystem>
 #include <algorithm>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <cstdio>
 #include "gif.h"
 #include "stb_image.h"
+#include "MakeFrame.h"
+#include "ThreadPool.h"
+#include "Instrumentation.h"
+#include "Trace.h"
 
 namespace fs = std::filesystem;
 
+namespace {
+
+using RgbaFrame = std::vector<uint8_t>;
+
+struct GifBufferDeleter {
+    void operator()(GifBuffer* buf) const {
+        GifBufferFree(buf);
+        delete buf;
+    }
+};
+using EncodedFrame = std::unique_ptr<GifBuffer, GifBufferDeleter>;
+
+RgbaFrame toRgba(const Image& img) {
+    QT_COUNT_ALLOC(GIF_RENDER, 1);
+    const std::vector<Pixel>& pixels = img.getPixelData();
+    RgbaFrame rgba(pixels.size() * 4);
+    for (size_t i = 0; i < pixels.size(); ++i) {
+        rgba[i * 4 + 0] = pixels[i].r;
+        rgba[i * 4 + 1] = pixels[i].g;
+        rgba[i * 4 + 2] = pixels[i].b;
+        rgba[i * 4 + 3] = 255;
+    }
+    return rgba;
+}
+
+// Setiap worker memakai kamus LZW miliknya sendiri yang dipakai ulang antar frame
+GifLzwDict* threadLzwDict() {
+    thread_local std::unique_ptr<GifLzwDict> dict = [] {
+        std::unique_ptr<GifLzwDict> d(new GifLzwDict);
+        GifLzwDictInit(d.get());
+        return d;
+    }();
+    return dict.get();
+}
+
+// Cache palet juga per worker; hanya generasinya yang dinaikkan setiap frame
+GifPaletteCache* threadPaletteCache() {
+    thread_local std::unique_ptr<GifPaletteCache> cache = [] {
+        std::unique_ptr<GifPaletteCache> c(new GifPaletteCache);
+        GifPaletteCacheInit(c.get());
+        return c;
+    }();
+    return cache.get();
+}
+
+struct DirtyRect {
+    uint32_t left = 0, top = 0, width = 0, height = 0;
+};
+
+// Mencari persegi terkecil yang memuat semua piksel yang berubah antara dua frame
+DirtyRect findDirtyRect(const RgbaFrame& previous, const RgbaFrame& current, uint32_t width, uint32_t height) {
+    const size_t rowBytes = static_cast<size_t>(width) * 4;
+    uint32_t top = 0;
+    while (top < height && std::equal(previous.begin() + top * rowBytes, previous.begin() + (top + 1) * rowBytes,
+                                      current.begin() + top * rowBytes)) {
+        ++top;
+    }
+    if (top == height) {
+        return DirtyRect{};
+    }
+    uint32_t bottom = height;
+    while (bottom > top && std::equal(previous.begin() + (bottom - 1) * rowBytes, previous.begin() + bottom * rowBytes,
+                                      current.begin() + (bottom - 1) * rowBytes)) {
+        --bottom;
+    }
+
+    uint32_t left = width, right = 0;
+    for (uint32_t y = top; y < bottom; ++y) {
+        const size_t row = y * rowBytes;
+        uint32_t x = 0;
+        while (x < left && std::equal(&previous[row + x * 4], &previous[row + x * 4 + 4], &current[row + x * 4])) {
+            ++x;
+        }
+        left = std::min(left, x);
+        x = width;
+        while (x > right && std::equal(&previous[row + (x - 1) * 4], &previous[row + x * 4], &current[row + (x - 1) * 4])) {
+            --x;
+        }
+        right = std::max(right, x);
+    }
+    return DirtyRect{left, top, right - left, bottom - top};
+}
+
+RgbaFrame cropRgba(const RgbaFrame& frame, uint32_t canvasWidth, const DirtyRect& rect) {
+    RgbaFrame out(static_cast<size_t>(rect.width) * rect.height * 4);
+    for (uint32_t y = 0; y < rect.height; ++y) {
+        auto src = frame.begin() + ((static_cast<size_t>(rect.top) + y) * canvasWidth + rect.left) * 4;
+        std::copy(src, src + rect.width * 4, out.begin() + static_cast<size_t>(y) * rect.width * 4);
+    }
+    return out;
+}
+
+// Delta frame i dihitung terhadap frame i-1 hasil render (bukan hasil kuantisasi),
+// sehingga tiap frame bisa di-encode tanpa menunggu frame sebelumnya selesai di-encode.
+// Hanya persegi yang berubah yang di-encode.
+EncodedFrame encodeFrame(const RgbaFrame* previous, const RgbaFrame& current,
+                         uint32_t width, uint32_t height, uint32_t delay) {
+    QT_SCOPED_TIMER(GIF_ENCODE, static_cast<uint64_t>(width) * height);
+    QT_COUNT_ALLOC(GIF_ENCODE, 1);
+    EncodedFrame out(new GifBuffer);
+    GifBufferInit(out.get());
+
+    if (!previous) {
+        RgbaFrame quantized(current.size());
+        GifEncodeFrame(nullptr, current.data(), quantized.data(),
+                       width, height, delay, 8, false, threadLzwDict(), threadPaletteCache(), out.get());
+        return out;
+    }
+
+    DirtyRect rect = findDirtyRect(*previous, current, width, height);
+    if (rect.width == 0 || rect.height == 0) {
+        // Frame tetap harus ditulis agar delay-nya berlaku; satu piksel transparan sudah cukup
+        rect = DirtyRect{0, 0, 1, 1};
+    }
+
+    RgbaFrame lastRect = cropRgba(*previous, width, rect);
+    RgbaFrame nextRect = cropRgba(current, width, rect);
+    GifEncodeFrameRect(lastRect.data(), nextRect.data(), lastRect.data(), rect.left, rect.top,
+                       rect.width, rect.height, delay, 8, false, threadLzwDict(), threadPaletteCache(), out.get());
+    return out;
+}
+
+bool callByteSink(void* context, const uint8_t* data, size_t size) {
+    return (*static_cast<const MakeGif::ByteSink*>(context))(data, size);
+}
+
+} // namespace
+
 void MakeGif::create(const std::string& folderPath, const std::string& outputGif) {
     std::vector<std::string> frameFiles;
 
@@ -70,3 +206,120 @@ void MakeGif::create(const std::string& folderPath, const std::string& outputGif
     GifEnd(&writer);
     std::cout << "GIF berhasil dibuat: " << outputGif << std::endl;
 }
+
+
+bool MakeGif::stream(const Image& sourceImage, const Quadtree* finalTree,
+                     const GifSchedule& schedule, const ByteSink& sink,
+                     unsigned threadCount) {
+    if (sourceImage.isEmpty()) {
+        std::cerr << "Gambar sumber kosong, GIF tidak dibuat." << std::endl;
+        return false;
+    }
+
+    const uint32_t width = static_cast<uint32_t>(sourceImage.getWidth());
+    const uint32_t height = static_cast<uint32_t>(sourceImage.getHeight());
+    const int totalFrames = schedule.totalFrames();
+
+    if (schedule.mode == GifSchedule::Mode::DEPTH && !finalTree) {
+        throw std::invalid_argument("Mode frame DEPTH membutuhkan pohon final.");
+    }
+
+    // Frame sudah di-encode sebagai persegi yang berubah, jadi writer tidak perlu salinan kanvas
+    GifWriter writer = {};
+    if (!GifBeginSink(&writer, callByteSink, const_cast<ByteSink*>(&sink), width, height, schedule.frameDelay,
+                      static_cast<uint16_t>(std::clamp(schedule.loopCount, 0, 0xffff)), false)) {
+        std::cerr << "Gagal menulis header GIF." << std::endl;
+        return false;
+    }
+
+    ThreadPool pool(threadCount);
+
+    // Batasi jumlah frame yang sedang diproses agar memori tidak menampung semua frame sekaligus
+    const int window = static_cast<int>(pool.size()) * 2;
+
+    std::vector<std::shared_future<RgbaFrame>> rendered(totalFrames);
+    std::vector<std::future<EncodedFrame>> encoded(totalFrames);
+
+    // Render frame i di-submit sebelum encode frame i, dan pool menjalankan task secara FIFO,
+    // jadi encode yang menunggu hasil render tidak pernah memblokir render yang dibutuhkannya.
+    auto submitFrame = [&](int i) {
+        rendered[i] = pool.submit([&sourceImage, finalTree, &schedule, i]() {
+            Trace::Scope trace("gif", "render frame " + std::to_string(i));
+            return toRgba(MakeFrame::renderFrame(sourceImage, finalTree, schedule, i));
+        }).share();
+
+        std::shared_future<RgbaFrame> current = rendered[i];
+        std::shared_future<RgbaFrame> previous = (i > 0) ? rendered[i - 1] : std::shared_future<RgbaFrame>();
+        const uint32_t delay = schedule.delayFor(i);
+        encoded[i] = pool.submit([current, previous, width, height, delay, i]() {
+            // Tunggu render selesai sebelum event encode dimulai agar waktu tunggu tidak ikut terhitung
+            const RgbaFrame& currentFrame = current.get();
+            const RgbaFrame* previousFrame = previous.valid() ? &previous.get() : nullptr;
+            Trace::Scope trace("gif", "encode frame " + std::to_string(i));
+            return encodeFrame(previousFrame, currentFrame, width, height, delay);
+        });
+    };
+
+    int scheduled = 0;
+    for (; scheduled < std::min(window, totalFrames); ++scheduled) {
+        submitFrame(scheduled);
+    }
+
+    bool ok = true;
+    try {
+        for (int i = 0; i < totalFrames && ok; ++i) {
+            EncodedFrame frame = encoded[i].get();
+            QT_SCOPED_TIMER(GIF_WRITE, 0);
+            Trace::Scope trace("gif", "write frame " + std::to_string(i));
+            ok = GifWriteEncodedFrame(&writer, frame.get());
+
+            // Frame i-1 tidak dibutuhkan lagi setelah frame i selesai di-encode
+            if (i > 0) {
+                rendered[i - 1] = std::shared_future<RgbaFrame>();
+            }
+            if (scheduled < totalFrames) {
+                submitFrame(scheduled++);
+            }
+        }
+    } catch (...) {
+        GifEnd(&writer);
+        throw;
+    }
+
+    return GifEnd(&writer) && ok;
+}
+
+bool MakeGif::create(const Image& sourceImage, const Quadtree* finalTree,
+                     const GifSchedule& schedule, const std::string& outputGif,
+                     unsigned threadCount) {
+    std::unique_ptr<FILE, int (*)(FILE*)> file(std::fopen(outputGif.c_str(), "wb"), &std::fclose);
+    if (!file) {
+        std::cerr << "Gagal membuat GIF." << std::endl;
+        return false;
+    }
+
+    FILE* f = file.get();
+    bool ok = stream(sourceImage, finalTree, schedule, [f](const uint8_t* data, size_t size) {
+        return std::fwrite(data, 1, size, f) == size;
+    }, threadCount);
+
+    if (!ok || std::fclose(file.release()) != 0) {
+        std::cerr << "Gagal menulis GIF: " << outputGif << std::endl;
+        return false;
+    }
+    return true;
+}
+
+std::vector<uint8_t> MakeGif::encode(const Image& sourceImage, const Quadtree* finalTree,
+                                     const GifSchedule& schedule, unsigned threadCount) {
+    std::vector<uint8_t> bytes;
+    bool ok = stream(sourceImage, finalTree, schedule, [&bytes](const uint8_t* data, size_t size) {
+        bytes.insert(bytes.end(), data, data + size);
+        return true;
+    }, threadCount);
+
+    if (!ok) {
+        throw std::runtime_error("Gagal meng-encode GIF ke memori.");
+    }
+    return bytes;
+}
@@ -2,10 +2,35 @@
 #define MAKEGIF_H
 
 #include <string>
+#include <vector>
+#include <cstdint>
+#include <functional>
+#include "Image.h"
+#include "MakeFrame.h"
 
 class MakeGif {
 public:
     static void create(const std::string& folderPath, const std::string& outputGif);
+
+    // Tujuan byte GIF; mengembalikan false jika penulisan gagal
+    using ByteSink = std::function<bool(const uint8_t* data, size_t size)>;
+
+    // Membuat GIF langsung dari gambar sumber tanpa folder frame sementara, mengikuti jadwal.
+    // Frame dibuat, dikuantisasi, dan di-encode LZW secara paralel di thread pool, lalu
+    // dialirkan berurutan ke sink dalam blok besar. Hanya persegi yang berubah dari frame
+    // sebelumnya yang di-encode. threadCount = 0 memakai semua core.
+    static bool stream(const Image& sourceImage, const Quadtree* finalTree,
+                       const GifSchedule& schedule, const ByteSink& sink,
+                       unsigned threadCount = 0);
+
+    // Sama seperti stream, dengan tujuan file
+    static bool create(const Image& sourceImage, const Quadtree* finalTree,
+                       const GifSchedule& schedule, const std::string& outputGif,
+                       unsigned threadCount = 0);
+
+    // Sama seperti stream, dengan tujuan buffer di memori (misalnya untuk respons HTTP)
+    static std::vector<uint8_t> encode(const Image& sourceImage, const Quadtree* finalTree,
+                                       const GifSchedule& schedule, unsigned threadCount = 0);
 };
 
 #endif // MAKEGIF_H
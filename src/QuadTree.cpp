@@ -1,4 +1,6 @@
 #include "QuadTree.h"
+#include "Instrumentation.h"
+#include "Trace.h"
 #include <cmath>        
 #include <vector>
 #include <numeric>      
@@ -8,28 +10,93 @@
 #include <algorithm>    
 #include <array>        
 #include <unordered_map>
+#include <optional>
+#include <queue>
 
 QuadTreeNode::QuadTreeNode(int x, int y, int width, int height, const Image& image)
-    : x(x), y(y), width(width), height(height), leaf(true), sourceImage(image), children({}) // Inisialisasi children
+    : x(x), y(y), width(width), height(height), leaf(true), children({}), sourceImage(image) // Inisialisasi children
 {
     if (width <= 0 || height <= 0) {
         throw std::invalid_argument("Node dimensions must be positive.");
     }
     try {
-        averageColor = calculateAverageColor();
+        averageColor = calculateAverageColor(squaredError);
     } catch (const std::exception& e) {
          std::cerr << "Error calculating initial average color for node (" << x << "," << y << "): " << e.what() << std::endl;
          averageColor = Pixel(0, 0, 0);
     }
 }
 
-// Menghitung warna rata-rata untuk region node ini
-Pixel QuadTreeNode::calculateAverageColor() const {
+QuadTreeNode::QuadTreeNode(int x, int y, int width, int height, const Image& image, const RegionStats& stats,
+                           bool fitPlane)
+    : x(x), y(y), width(width), height(height), leaf(true), children({}), sourceImage(image)
+{
+    if (width <= 0 || height <= 0) {
+        throw std::invalid_argument("Node dimensions must be positive.");
+    }
+    const RegionStats::Sums sums = stats.rectSums(x, y, width, height);
+    const long long sum[3] = {static_cast<long long>(sums[0]), static_cast<long long>(sums[1]), static_cast<long long>(sums[2])};
+    const long long sumSq[3] = {static_cast<long long>(sums[3]), static_cast<long long>(sums[4]), static_cast<long long>(sums[5])};
+    averageColor = colorFromSums(sum, sumSq, static_cast<long long>(width) * height, squaredError);
+    if (!fitPlane) {
+        return;
+    }
+
+    // Pada grid persegi panjang, x dan y terpusat saling ortogonal, sehingga kemiringan least
+    // squares tiap sumbu = sum (x - cx) p / sum (x - cx)^2, dan setiap sumbu mengurangi SSE
+    // sebesar kemiringan^2 x sum (x - cx)^2
+    const RegionStats::Moments moments = stats.rectMoments(x, y, width, height);
+    const double area = static_cast<double>(width) * height;
+    const double cx = x + (width - 1) / 2.0;
+    const double cy = y + (height - 1) / 2.0;
+    const double sxx = static_cast<double>(height) * width * (static_cast<double>(width) * width - 1.0) / 12.0;
+    const double syy = static_cast<double>(width) * height * (static_cast<double>(height) * height - 1.0) / 12.0;
+    for (int c = 0; c < 3; ++c) {
+        const double sxp = static_cast<double>(moments[c]) - cx * static_cast<double>(sum[c]);
+        const double syp = static_cast<double>(moments[c + 3]) - cy * static_cast<double>(sum[c]);
+        const double gx = sxx > 0.0 ? sxp / sxx : 0.0;
+        const double gy = syy > 0.0 ? syp / syy : 0.0;
+        gradientX[c] = static_cast<float>(gx);
+        gradientY[c] = static_cast<float>(gy);
+        squaredError[c] = static_cast<float>(std::max(0.0, squaredError[c] - gx * gx * sxx - gy * gy * syy));
+    }
+    if (!hasGradient()) {
+        return;
+    }
+    // Bidang melewati rata-rata tepat, bukan warna bulat; tanpa ini setiap piksel bergeser sampai
+    // setengah tingkat dan SSE bertambah luas x selisih^2 (sum (p - a)^2 = sum (p - m)^2 + n (m - a)^2)
+    const int rounded[3] = {averageColor.r, averageColor.g, averageColor.b};
+    for (int c = 0; c < 3; ++c) {
+        const double offset = static_cast<double>(sum[c]) / area - rounded[c];
+        meanOffset[c] = static_cast<float>(offset);
+        squaredError[c] = static_cast<float>(std::max(0.0, squaredError[c] - area * offset * offset));
+    }
+}
+
+// Warna rata-rata dengan pembulatan standar (tambah setengah sebelum pembagian integer),
+// dan jumlah kuadrat selisih tiap channel terhadap warna itu:
+// sum (p - a)^2 = sum p^2 - 2a sum p + n a^2, tepat dalam bilangan bulat
+Pixel QuadTreeNode::colorFromSums(const long long sum[3], const long long sumSq[3], long long count,
+                                  std::array<float, 3>& channelSquaredError) {
+    long long avg[3];
+    for (int c = 0; c < 3; ++c) {
+        avg[c] = (sum[c] + count / 2) / count;
+        channelSquaredError[c] = static_cast<float>(sumSq[c] - 2 * avg[c] * sum[c] + count * avg[c] * avg[c]);
+    }
+    return Pixel(static_cast<unsigned char>(avg[0]), static_cast<unsigned char>(avg[1]), static_cast<unsigned char>(avg[2]));
+}
+
+// Menghitung warna rata-rata untuk region node ini, sekaligus jumlah kuadrat selisih tiap
+// channel terhadap warna rata-rata tersebut (dari jumlah kuadrat pada lintasan yang sama)
+Pixel QuadTreeNode::calculateAverageColor(std::array<float, 3>& channelSquaredError) const {
+    channelSquaredError = {0.0f, 0.0f, 0.0f};
     if (width <= 0 || height <= 0) {
         return Pixel(0, 0, 0);
     }
+    QT_SCOPED_TIMER(AVERAGE_COLOR, static_cast<long long>(width) * height);
 
     long long sumR = 0, sumG = 0, sumB = 0;
+    long long sumSqR = 0, sumSqG = 0, sumSqB = 0;
     long long count = 0;
 
     for (int i = y; i < y + height; ++i) {
@@ -40,6 +107,9 @@ Pixel QuadTreeNode::calculateAverageColor() const {
                     sumR += p.r;
                     sumG += p.g;
                     sumB += p.b;
+                    sumSqR += p.r * p.r;
+                    sumSqG += p.g * p.g;
+                    sumSqB += p.b * p.b;
                     count++;
                 } else {
                      std::cerr << "Warning: Skipping pixel outside source image bounds during average calculation (" << j << ", " << i << ")\n";
@@ -55,12 +125,107 @@ Pixel QuadTreeNode::calculateAverageColor() const {
         return Pixel(0, 0, 0);
     }
 
-    // Lakukan pembulatan standar (tambah setengah sebelum pembagian integer)
-    unsigned char avgR = static_cast<unsigned char>((sumR + count / 2) / count);
-    unsigned char avgG = static_cast<unsigned char>((sumG + count / 2) / count);
-    unsigned char avgB = static_cast<unsigned char>((sumB + count / 2) / count);
+    const long long sum[3] = {sumR, sumG, sumB};
+    const long long sumSq[3] = {sumSqR, sumSqG, sumSqB};
+    return colorFromSums(sum, sumSq, count, channelSquaredError);
+}
+
+double QuadTreeNode::getSquaredError() const {
+    return static_cast<double>(squaredError[0]) + squaredError[1] + squaredError[2];
+}
+
+bool QuadTreeNode::hasGradient() const {
+    for (int c = 0; c < 3; ++c) {
+        if (gradientX[c] != 0.0f || gradientY[c] != 0.0f) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void QuadTreeNode::paint(Image& targetImage) const {
+    QT_SCOPED_TIMER(RECONSTRUCT, static_cast<long long>(width) * height);
+    const int startX = std::max(x, 0);
+    const int startY = std::max(y, 0);
+    const int endX = std::min(x + width, targetImage.getWidth());
+    const int endY = std::min(y + height, targetImage.getHeight());
+    if (startX >= endX || startY >= endY) {
+        return;
+    }
+    std::vector<Pixel>& pixels = targetImage.getPixelData();
+    const size_t stride = static_cast<size_t>(targetImage.getWidth());
+    if (!hasGradient()) {
+        for (int i = startY; i < endY; ++i) {
+            std::fill(pixels.begin() + i * stride + startX, pixels.begin() + i * stride + endX, averageColor);
+        }
+        return;
+    }
+
+    // Kernel baris tanpa percabangan (clamp + pemotongan setelah +0.5 = pembulatan), sehingga
+    // loop dalam dapat divektorisasi compiler pada -O3
+    const float cx = x + (width - 1) * 0.5f;
+    const float cy = y + (height - 1) * 0.5f;
+    const float avg[3] = {averageColor.r + meanOffset[0], averageColor.g + meanOffset[1], averageColor.b + meanOffset[2]};
+    const int count = endX - startX;
+    for (int i = startY; i < endY; ++i) {
+        float base[3];
+        for (int c = 0; c < 3; ++c) {
+            base[c] = avg[c] + gradientY[c] * (i - cy) + gradientX[c] * (startX - cx) + 0.5f;
+        }
+        Pixel* row = pixels.data() + i * stride + startX;
+        for (int j = 0; j < count; ++j) {
+            const float fj = static_cast<float>(j);
+            row[j].r = static_cast<unsigned char>(std::min(std::max(base[0] + gradientX[0] * fj, 0.0f), 255.0f));
+            row[j].g = static_cast<unsigned char>(std::min(std::max(base[1] + gradientX[1] * fj, 0.0f), 255.0f));
+            row[j].b = static_cast<unsigned char>(std::min(std::max(base[2] + gradientX[2] * fj, 0.0f), 255.0f));
+        }
+    }
+}
+
+double QuadTreeNode::calculatePlaneResidualError(ErrorMetric metric) const {
+    const std::vector<Pixel>& pixels = sourceImage.getPixelData();
+    const size_t stride = static_cast<size_t>(sourceImage.getWidth());
+    const double cx = x + (width - 1) / 2.0;
+    const double cy = y + (height - 1) / 2.0;
+    double absSum[3] = {0, 0, 0};
+    double minResidual[3] = {std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity(),
+                             std::numeric_limits<double>::infinity()};
+    double maxResidual[3] = {-std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity(),
+                             -std::numeric_limits<double>::infinity()};
+    const double avg[3] = {static_cast<double>(averageColor.r) + meanOffset[0], static_cast<double>(averageColor.g) + meanOffset[1],
+                           static_cast<double>(averageColor.b) + meanOffset[2]};
+    for (int i = y; i < y + height; ++i) {
+        const Pixel* row = pixels.data() + i * stride;
+        for (int j = x; j < x + width; ++j) {
+            const double value[3] = {static_cast<double>(row[j].r), static_cast<double>(row[j].g),
+                                     static_cast<double>(row[j].b)};
+            for (int c = 0; c < 3; ++c) {
+                const double residual = value[c] - (avg[c] + gradientX[c] * (j - cx) + gradientY[c] * (i - cy));
+                absSum[c] += std::abs(residual);
+                minResidual[c] = std::min(minResidual[c], residual);
+                maxResidual[c] = std::max(maxResidual[c], residual);
+            }
+        }
+    }
+    double error = 0.0;
+    for (int c = 0; c < 3; ++c) {
+        error += metric == ErrorMetric::MAD ? absSum[c] / (static_cast<double>(width) * height)
+                                            : maxResidual[c] - minResidual[c];
+    }
+    return error / 3.0;
+}
 
-    return Pixel(avgR, avgG, avgB);
+double QuadTreeNode::getSSIM() const {
+    // Blok berwarna rata tidak punya varians, sehingga SSIM per channel = C2 / (varians + C2)
+    // dengan varians = SSE / n (selisih rata-rata terhadap warna bulat diabaikan). Untuk
+    // PLANE, varians residu terhadap bidang dipakai sebagai pendekatan.
+    const double C2 = (0.03 * 255) * (0.03 * 255);
+    const double area = static_cast<double>(width) * height;
+    double ssim = 0.0;
+    for (float channelError : squaredError) {
+        ssim += C2 / (channelError / area + C2);
+    }
+    return ssim / 3.0;
 }
 
 double QuadTreeNode::calculateError(ErrorMetric metric) const {
@@ -88,6 +253,7 @@ double QuadTreeNode::calculateError(ErrorMetric metric) const {
 // Implementasi fungsi perhitungan error internal (statis)
 double QuadTreeNode::calculateVarianceInternal(const Image& img, int x, int y, int w, int h) {
     if (w <= 0 || h <= 0) return 0.0;
+    QT_SCOPED_TIMER(METRIC_VARIANCE, static_cast<long long>(w) * h);
     long long totalPixels = static_cast<long long>(w) * h;
     if (totalPixels == 0) return 0.0;
 
@@ -119,6 +285,7 @@ double QuadTreeNode::calculateVarianceInternal(const Image& img, int x, int y, i
 
 double QuadTreeNode::calculateMADInternal(const Image& img, int x, int y, int w, int h) {
     if (w <= 0 || h <= 0) return 0.0;
+    QT_SCOPED_TIMER(METRIC_MAD, static_cast<long long>(w) * h);
     long long totalPixels = static_cast<long long>(w) * h;
      if (totalPixels == 0) return 0.0;
 
@@ -150,6 +317,7 @@ double QuadTreeNode::calculateMADInternal(const Image& img, int x, int y, int w,
 
 double QuadTreeNode::calculateMaxPixelDifferenceInternal(const Image& img, int x, int y, int w, int h) {
      if (w <= 0 || h <= 0) return 0.0;
+    QT_SCOPED_TIMER(METRIC_MAX, static_cast<long long>(w) * h);
 
     int minR = 255, minG = 255, minB = 255;
     int maxR = 0, maxG = 0, maxB = 0;
@@ -179,6 +347,7 @@ double QuadTreeNode::calculateMaxPixelDifferenceInternal(const Image& img, int x
 
 double QuadTreeNode::calculateEntropyInternal(const Image& img, int x, int y, int w, int h) {
     if (w <= 0 || h <= 0) return 0.0;
+    QT_SCOPED_TIMER(METRIC_ENTROPY, static_cast<long long>(w) * h);
     long long totalPixels = static_cast<long long>(w) * h;
     if (totalPixels == 0) return 0.0;
 
@@ -214,6 +383,7 @@ double QuadTreeNode::calculateEntropyInternal(const Image& img, int x, int y, in
 
 double QuadTreeNode::calculateSSIMInternal(const Image& img, int x, int y, int w, int h) const {
     if (w <= 0 || h <= 0) return 1.0;
+    QT_SCOPED_TIMER(METRIC_SSIM, static_cast<long long>(w) * h);
     long long totalPixels = static_cast<long long>(w) * h;
     if (totalPixels == 0) return 1.0;
 
@@ -314,21 +484,7 @@ void QuadTreeNode::collectNodes(std::vector<const QuadTreeNode*>& nodes) const {
 
 void QuadTreeNode::reconstructRegion(Image& targetImage) const {
     if (leaf) {
-        // Isi area persegi panjang pada targetImage dengan averageColor
-        int endY = std::min(y + height, targetImage.getHeight());
-        int endX = std::min(x + width, targetImage.getWidth());
-        int startY = std::max(y, 0);
-        int startX = std::max(x, 0);
-
-        for (int i = startY; i < endY; ++i) {
-            for (int j = startX; j < endX; ++j) {
-                 try {
-                    targetImage.setPixel(i, j, averageColor);
-                 } catch (const std::out_of_range&) {
-                     std::cerr << "Warning: Reconstruction coordinate out of target bounds (" << j << ", " << i << ") despite checks.\n";
-                 }
-            }
-        }
+        paint(targetImage);
     } else {
         for (int i = 0; i < 4; ++i) {
              if (children[i]) { // Periksa apakah pointer valid
@@ -338,8 +494,35 @@ void QuadTreeNode::reconstructRegion(Image& targetImage) const {
     }
 }
 
+void QuadTreeNode::reconstructRegion(Image& targetImage, int maxDepth, int currentDepth) const {
+    if (leaf || currentDepth >= maxDepth) {
+        paint(targetImage);
+    } else {
+        for (int i = 0; i < 4; ++i) {
+             if (children[i]) {
+                 children[i]->reconstructRegion(targetImage, maxDepth, currentDepth + 1);
+             }
+        }
+    }
+}
+
+void QuadTreeNode::reconstructRegionSplits(Image& targetImage, int splitLimit) const {
+    if (leaf || splitOrder < 0 || splitOrder >= splitLimit) {
+        paint(targetImage);
+        return;
+    }
+    for (const auto& child : children) {
+        if (child) {
+            child->reconstructRegionSplits(targetImage, splitLimit);
+        }
+    }
+}
 
 Quadtree::Quadtree(const Image& image, ErrorMetric metric, double threshold, int minSize)
+    : Quadtree(image, metric, threshold, minSize, QuadtreeOptions{}) {}
+
+Quadtree::Quadtree(const Image& image, ErrorMetric metric, double threshold, int minSize,
+                   const QuadtreeOptions& options)
     : sourceImage(image),
       imageWidth(image.getWidth()),
       imageHeight(image.getHeight()),
@@ -347,7 +530,17 @@ Quadtree::Quadtree(const Image& image, ErrorMetric metric, double threshold, int
       errorThreshold(threshold),
       minimumBlockSize(std::max(1, minSize)), // minSize minimal 1
       nodeCount(0), 
-      maxDepth(0)     
+      maxDepth(0),
+      memoryBudgetBytes(options.memoryBudgetBytes),
+      requestedMinBlockSize(std::max(1, minSize)),
+      buildMode(options.buildMode),
+      maxLeaves(options.maxLeaves),
+      weightByArea(options.weightByArea),
+      lambda(options.lambda),
+      targetRateBits(options.targetRateBits),
+      splitMode(options.splitMode),
+      mergeTolerance(options.mergeTolerance),
+      leafModel(options.leafModel)
 {
     if (image.isEmpty()) {
         throw std::runtime_error("Cannot create Quadtree from an empty image.");
@@ -355,22 +548,270 @@ Quadtree::Quadtree(const Image& image, ErrorMetric metric, double threshold, int
     if (imageWidth <= 0 || imageHeight <= 0) {
          throw std::runtime_error("Image dimensions must be positive.");
     }
+    if (leafModel == LeafModel::PLANE &&
+        (metric == ErrorMetric::ENTROPY || metric == ErrorMetric::SSIM)) {
+        throw std::invalid_argument("Model leaf bidang hanya mendukung metrik variance, mad, dan max.");
+    }
+    if (leafModel == LeafModel::PLANE && mergeTolerance >= 0) {
+        throw std::invalid_argument("Penggabungan leaf tidak dapat dipakai dengan model leaf bidang.");
+    }
+    if (regionStatsBytes(image.getWidth(), image.getHeight(), splitMode, leafModel) > 0) {
+        Trace::Scope trace("build", "region stats");
+        regionStats = std::make_unique<RegionStats>(image, leafModel == LeafModel::PLANE);
+    }
 
-    try {
-        rootNode = std::make_unique<QuadTreeNode>(0, 0, imageWidth, imageHeight, sourceImage);
-    } catch (const std::exception& e) {
-        throw std::runtime_error(std::string("Failed to create root node: ") + e.what());
+    build();
+}
+
+void Quadtree::build() {
+    if (buildMode == BuildMode::BEST_FIRST) {
+        Trace::Scope trace("build", "build tree (best-first)");
+        buildBestFirst();
+        trace.arg("nodes", static_cast<double>(nodeCount));
+        trace.arg("splits", static_cast<double>(leavesAfterSplit.size()));
+        mergeSimilarSiblings();
+        return;
     }
 
+    const long long imageArea = static_cast<long long>(imageWidth) * imageHeight;
+    while (true) {
+        nodeCount = 0;
+        maxDepth = 0;
+        allocatedNodes = 1;
+        budgetExceeded = false;
+
+        try {
+            rootNode = makeNode(0, 0, imageWidth, imageHeight);
+        } catch (const std::exception& e) {
+            throw std::runtime_error(std::string("Failed to create root node: ") + e.what());
+        }
+
+        if(rootNode) {
+            Trace::Scope trace("build", "build tree");
+            buildRecursive(rootNode.get(), 1);
+            trace.arg("nodes", static_cast<double>(nodeCount));
+            trace.arg("depth", maxDepth);
+            trace.arg("minBlockSize", minimumBlockSize);
+        }
 
-    if(rootNode) {
-        buildRecursive(rootNode.get(), 1);
+        if (!budgetExceeded) {
+            break;
+        }
+
+        // Pohon tidak muat di anggaran: buang dan ulangi dengan blok minimum 4x lebih besar.
+        // Dengan minBlockSize seluas gambar hanya root yang dibuat, jadi perulangan pasti berhenti.
+        rootNode.reset();
+        minimumBlockSize = static_cast<int>(std::min<long long>(imageArea, static_cast<long long>(minimumBlockSize) * 4));
     }
 
     if (nodeCount == 0 && rootNode) {
         nodeCount = 1;
         maxDepth = 1;
     }
+
+    if (buildMode == BuildMode::RATE_DISTORTION) {
+        Trace::Scope trace("build", "rd prune");
+        pruneRateDistortion();
+        trace.arg("lambda", lambda);
+        trace.arg("rateBits", rateBits);
+        trace.arg("nodes", static_cast<double>(nodeCount));
+    }
+    mergeSimilarSiblings();
+}
+
+void Quadtree::mergeSimilarSiblings() {
+    mergedColorRanges.clear();
+    if (mergeTolerance < 0 || !rootNode) {
+        return;
+    }
+    Trace::Scope trace("build", "merge siblings");
+    const size_t before = nodeCount;
+    ColorRange range;
+    mergeSiblingsRecursive(rootNode.get(), range);
+    recountNodes();
+    // Urutan split BEST_FIRST tidak lagi menggambarkan pohon yang digabung
+    leavesAfterSplit.clear();
+    trace.arg("removed", static_cast<double>(before - nodeCount));
+}
+
+bool Quadtree::mergeSiblingsRecursive(QuadTreeNode* node, ColorRange& range) {
+    if (node->leaf) {
+        range = leafColorRange(*node);
+        return true;
+    }
+    bool allLeaves = true;
+    bool first = true;
+    for (const auto& child : node->children) {
+        ColorRange childRange;
+        if (!child) {
+            continue;
+        }
+        if (!mergeSiblingsRecursive(child.get(), childRange)) {
+            allLeaves = false;
+        } else if (first) {
+            range = childRange;
+            first = false;
+        } else {
+            range.low = Pixel(std::min(range.low.r, childRange.low.r), std::min(range.low.g, childRange.low.g),
+                              std::min(range.low.b, childRange.low.b));
+            range.high = Pixel(std::max(range.high.r, childRange.high.r), std::max(range.high.g, childRange.high.g),
+                               std::max(range.high.b, childRange.high.b));
+        }
+    }
+    if (!allLeaves) {
+        return false;
+    }
+    // Warna induk menggantikan semua leaf asli di bawahnya, jadi batasnya diukur terhadap
+    // rentang warna asli tersebut (bukan warna anak yang mungkin sudah hasil gabungan);
+    // penggabungan berantai tidak menumpuk selisih melebihi mergeTolerance
+    const Pixel parent = node->averageColor;
+    if (parent.r - range.low.r > mergeTolerance || range.high.r - parent.r > mergeTolerance ||
+        parent.g - range.low.g > mergeTolerance || range.high.g - parent.g > mergeTolerance ||
+        parent.b - range.low.b > mergeTolerance || range.high.b - parent.b > mergeTolerance) {
+        return false;
+    }
+    for (const auto& child : node->children) {
+        if (child) {
+            mergedColorRanges.erase(child.get());
+        }
+    }
+    node->children = {};
+    node->leaf = true;
+    node->splitOrder = -1;
+    mergedColorRanges[node] = range;
+    return true;
+}
+
+ColorRange Quadtree::leafColorRange(const QuadTreeNode& leaf) const {
+    const auto it = mergedColorRanges.find(&leaf);
+    return it != mergedColorRanges.end() ? it->second : ColorRange{leaf.averageColor, leaf.averageColor};
+}
+
+// QUAD: split empat jika blok masih boleh dibagi, selain itu NONE.
+// ADAPTIVE: di antara pembagian yang anak terkecilnya masih >= minBlockSize, pilih penurunan
+// SSE per leaf tambahan terbesar. Seri dimenangkan split empat, lalu horizontal.
+// Dipanggil sekali per simpul; hasilnya diteruskan ke createChildren.
+Quadtree::SplitKind Quadtree::chooseSplit(const QuadTreeNode& node) const {
+    if (splitMode != SplitMode::ADAPTIVE) {
+        bool canDividePhysically = (node.width > 1 || node.height > 1);
+        long long currentArea = static_cast<long long>(node.width) * node.height;
+        long long areaAfterDivideRough = (currentArea + 3) / 4;
+        return canDividePhysically && currentArea > this->minimumBlockSize && areaAfterDivideRough >= this->minimumBlockSize
+            ? SplitKind::QUAD : SplitKind::NONE;
+    }
+    const int w = node.width;
+    const int h = node.height;
+    const int halfW = w / 2;
+    const int halfH = h / 2;
+    const long long minArea = minimumBlockSize;
+    const int x = node.x;
+    const int y = node.y;
+    const double parent = regionStats->squaredError(x, y, w, h);
+
+    SplitKind best = SplitKind::NONE;
+    double bestGain = -1.0;
+    auto consider = [&](SplitKind kind, double childrenError, int addedLeaves) {
+        const double gain = (parent - childrenError) / addedLeaves;
+        if (gain > bestGain) {
+            bestGain = gain;
+            best = kind;
+        }
+    };
+    if (halfW > 0 && halfH > 0 && static_cast<long long>(halfW) * halfH >= minArea) {
+        consider(SplitKind::QUAD,
+                 regionStats->squaredError(x, y, halfW, halfH) + regionStats->squaredError(x + halfW, y, w - halfW, halfH) +
+                     regionStats->squaredError(x, y + halfH, halfW, h - halfH) +
+                     regionStats->squaredError(x + halfW, y + halfH, w - halfW, h - halfH),
+                 3);
+    }
+    if (halfH > 0 && static_cast<long long>(w) * halfH >= minArea) {
+        consider(SplitKind::HORIZONTAL,
+                 regionStats->squaredError(x, y, w, halfH) + regionStats->squaredError(x, y + halfH, w, h - halfH), 1);
+    }
+    if (halfW > 0 && static_cast<long long>(halfW) * h >= minArea) {
+        consider(SplitKind::VERTICAL,
+                 regionStats->squaredError(x, y, halfW, h) + regionStats->squaredError(x + halfW, y, w - halfW, h), 1);
+    }
+    return best;
+}
+
+size_t Quadtree::childCountOf(const QuadTreeNode& node, SplitKind kind) {
+    switch (kind) {
+        case SplitKind::QUAD:
+            return static_cast<size_t>((node.width > 1 ? 2 : 1) * (node.height > 1 ? 2 : 1));
+        case SplitKind::HORIZONTAL:
+        case SplitKind::VERTICAL:
+            return 2;
+        case SplitKind::NONE:
+            break;
+    }
+    return 0;
+}
+
+std::unique_ptr<QuadTreeNode> Quadtree::makeNode(int x, int y, int width, int height) const {
+    if (regionStats) {
+        return std::make_unique<QuadTreeNode>(x, y, width, height, sourceImage, *regionStats,
+                                              leafModel == LeafModel::PLANE);
+    }
+    return std::make_unique<QuadTreeNode>(x, y, width, height, sourceImage);
+}
+
+double Quadtree::nodeError(const QuadTreeNode& node) const {
+    if (leafModel == LeafModel::PLANE) {
+        // Varians residu sudah tersimpan di simpul; metrik lain diukur terhadap bidang
+        if (errorMetricChoice == ErrorMetric::VARIANCE) {
+            return node.getSquaredError() / (3.0 * static_cast<double>(node.width) * node.height);
+        }
+        return node.calculatePlaneResidualError(errorMetricChoice);
+    }
+    // Varians rata-rata channel langsung dari tabel jumlah jika tersedia
+    if (regionStats && errorMetricChoice == ErrorMetric::VARIANCE) {
+        const double area = static_cast<double>(node.width) * node.height;
+        return regionStats->squaredError(node.x, node.y, node.width, node.height) / (3.0 * area);
+    }
+    return node.calculateError(errorMetricChoice);
+}
+
+size_t Quadtree::createChildren(QuadTreeNode* node, SplitKind kind) {
+    if (kind == SplitKind::HORIZONTAL || kind == SplitKind::VERTICAL) {
+        QT_SCOPED_TIMER(NODE_ALLOC, static_cast<long long>(node->width) * node->height);
+        if (kind == SplitKind::HORIZONTAL) {
+            const int halfHeight = node->height / 2;
+            node->children[0] = makeNode(node->x, node->y, node->width, halfHeight);
+            node->children[1] = makeNode(node->x, node->y + halfHeight, node->width, node->height - halfHeight);
+        } else {
+            const int halfWidth = node->width / 2;
+            node->children[0] = makeNode(node->x, node->y, halfWidth, node->height);
+            node->children[1] = makeNode(node->x + halfWidth, node->y, node->width - halfWidth, node->height);
+        }
+        allocatedNodes += 2;
+        QT_COUNT_ALLOC(NODE_ALLOC, 2);
+        return 2;
+    }
+
+    int halfWidth = node->width / 2;
+    int halfHeight = node->height / 2;
+    int widthRem = node->width - halfWidth;
+    int heightRem = node->height - halfHeight;
+
+    if (halfWidth == 0 && widthRem == 0) widthRem = 1;
+    if (halfHeight == 0 && heightRem == 0) heightRem = 1;
+
+    // Pembuatan anak diukur terpisah dari rekursi di bawahnya
+    QT_SCOPED_TIMER(NODE_ALLOC, static_cast<long long>(node->width) * node->height);
+    if (halfWidth > 0 && halfHeight > 0)
+        node->children[0] = makeNode(node->x, node->y, halfWidth, halfHeight);
+    if (widthRem > 0 && halfHeight > 0)
+        node->children[1] = makeNode(node->x + halfWidth, node->y, widthRem, halfHeight);
+    if (halfWidth > 0 && heightRem > 0)
+        node->children[2] = makeNode(node->x, node->y + halfHeight, halfWidth, heightRem);
+    if (widthRem > 0 && heightRem > 0)
+        node->children[3] = makeNode(node->x + halfWidth, node->y + halfHeight, widthRem, heightRem);
+    const auto created = static_cast<size_t>(std::count_if(node->children.begin(), node->children.end(),
+                                                           [](const auto& child) { return child != nullptr; }));
+    allocatedNodes += created;
+    QT_COUNT_ALLOC(NODE_ALLOC, created);
+    return created;
 }
 
 void Quadtree::buildRecursive(QuadTreeNode* node, int currentDepth) {
@@ -381,18 +822,17 @@ void Quadtree::buildRecursive(QuadTreeNode* node, int currentDepth) {
 
     this->nodeCount++;
     this->maxDepth = std::max(this->maxDepth, currentDepth);
+    QT_COUNT_CALL(BUILD_NODE);
 
+    const SplitKind kind = chooseSplit(*node);
+    const bool splittable = kind != SplitKind::NONE;
     double error = 0.0;
-    bool shouldCheckError = true;
-    bool canDividePhysically = (node->width > 1 || node->height > 1);
-    long long currentArea = static_cast<long long>(node->width) * node->height;
-    if (currentArea < this->minimumBlockSize || !canDividePhysically) {
-        shouldCheckError = false;
-    }
-
-    if (shouldCheckError) {
+    // RATE_DISTORTION dan threshold negatif membangun pohon penuh; error tidak diperlukan di sini
+    if (splittable && (buildMode == BuildMode::RATE_DISTORTION || errorThreshold < 0.0)) {
+        error = std::numeric_limits<double>::infinity();
+    } else if (splittable) {
          try {
-            error = node->calculateError(this->errorMetricChoice);
+            error = nodeError(*node);
          } catch (const std::exception& e){
              std::cerr << "Error calculating metric during buildRecursive: " << e.what() << std::endl;
              // Anggap error tinggi agar tidak memproses lebih lanjut jika ada masalah
@@ -400,36 +840,35 @@ void Quadtree::buildRecursive(QuadTreeNode* node, int currentDepth) {
          }
     }
 
-    long long areaAfterDivideRough = (currentArea + 3) / 4;
-
-    if (error <= this->errorThreshold || currentArea <= this->minimumBlockSize || !canDividePhysically || areaAfterDivideRough < this->minimumBlockSize) {
+    if (!splittable || error <= this->errorThreshold) {
         node->leaf = true;
         return; // Node ini menjadi leaf
     }
 
-    node->leaf = false;
-
-    int halfWidth = node->width / 2;
-    int halfHeight = node->height / 2;
-    int widthRem = node->width - halfWidth;
-    int heightRem = node->height - halfHeight;
+    // Root selalu boleh dibuat; split berikutnya hanya jika semua anaknya masih muat di anggaran
+    // (simpul di tepi gambar dan split adaptif membuat kurang dari empat anak)
+    if (memoryBudgetBytes > 0 && (allocatedNodes + childCountOf(*node, kind)) * bytesPerNode() > memoryBudgetBytes) {
+        budgetExceeded = true;
+        node->leaf = true;
+        return;
+    }
 
-    if (halfWidth == 0 && widthRem == 0) widthRem = 1;
-    if (halfHeight == 0 && heightRem == 0) heightRem = 1;
+    node->leaf = false;
 
     try {
-        if (halfWidth > 0 && halfHeight > 0)
-            node->children[0] = std::make_unique<QuadTreeNode>(node->x, node->y, halfWidth, halfHeight, node->sourceImage);
-        if (widthRem > 0 && halfHeight > 0)
-            node->children[1] = std::make_unique<QuadTreeNode>(node->x + halfWidth, node->y, widthRem, halfHeight, node->sourceImage);
-        if (halfWidth > 0 && heightRem > 0)
-            node->children[2] = std::make_unique<QuadTreeNode>(node->x, node->y + halfHeight, halfWidth, heightRem, node->sourceImage);
-        if (widthRem > 0 && heightRem > 0)
-            node->children[3] = std::make_unique<QuadTreeNode>(node->x + halfWidth, node->y + halfHeight, widthRem, heightRem, node->sourceImage);
+        createChildren(node, kind);
 
         for (int i = 0; i < 4; ++i) {
             if (node->children[i]) {
+                // Subpohon tingkat atas dicatat sebagai event terpisah pada trace
+                std::optional<Trace::Scope> subtree;
+                if (currentDepth == 1) {
+                    subtree.emplace("build", "subtree " + std::to_string(i));
+                }
                 buildRecursive(node->children[i].get(), currentDepth + 1);
+                if (budgetExceeded) {
+                    return; // pohon ini akan dibuang dan dibangun ulang
+                }
             }
         }
     } catch (const std::exception& e) {
@@ -439,13 +878,300 @@ void Quadtree::buildRecursive(QuadTreeNode* node, int currentDepth) {
     }
 }
 
+void Quadtree::buildBestFirst() {
+    try {
+        rootNode = makeNode(0, 0, imageWidth, imageHeight);
+    } catch (const std::exception& e) {
+        throw std::runtime_error(std::string("Failed to create root node: ") + e.what());
+    }
+    nodeCount = 1;
+    maxDepth = 1;
+    allocatedNodes = 1;
+    leavesAfterSplit.clear();
+
+    struct Candidate {
+        double priority;
+        uint64_t sequence;  // urutan masuk, pemecah seri agar hasil deterministik
+        QuadTreeNode* node;
+        int depth;
+        SplitKind kind;     // pembagian yang dipilih saat simpul masuk antrian
+    };
+    auto lowerPriority = [](const Candidate& a, const Candidate& b) {
+        return a.priority != b.priority ? a.priority < b.priority : a.sequence > b.sequence;
+    };
+    std::priority_queue<Candidate, std::vector<Candidate>, decltype(lowerPriority)> heap(lowerPriority);
+    uint64_t sequence = 0;
+
+    // Hanya simpul yang boleh di-split dan error-nya di atas threshold yang masuk antrian
+    auto consider = [&](QuadTreeNode* node, int depth) {
+        QT_COUNT_CALL(BUILD_NODE);
+        const SplitKind kind = chooseSplit(*node);
+        if (kind == SplitKind::NONE) {
+            return;
+        }
+        double error = nodeError(*node);
+        if (error <= errorThreshold) {
+            return;
+        }
+        const double area = static_cast<double>(node->width) * node->height;
+        heap.push(Candidate{weightByArea ? error * area : error, sequence++, node, depth, kind});
+    };
+
+    consider(rootNode.get(), 1);
+    size_t leaves = 1;
+    while (!heap.empty()) {
+        // Split yang melebihi batas tidak dilewati demi split lain yang lebih kecil,
+        // sehingga pohon dengan batas lebih kecil selalu merupakan awalan pohon ini
+        const Candidate top = heap.top();
+        const size_t childCount = childCountOf(*top.node, top.kind);
+        if (maxLeaves > 0 && leaves + childCount - 1 > maxLeaves) {
+            break;
+        }
+        if (memoryBudgetBytes > 0 && (allocatedNodes + childCount) * bytesPerNode() > memoryBudgetBytes) {
+            break;
+        }
+        heap.pop();
+
+        size_t created = 0;
+        try {
+            created = createChildren(top.node, top.kind);
+        } catch (const std::exception& e) {
+            std::cerr << "Error creating child nodes for node (" << top.node->x << "," << top.node->y << "): " << e.what() << ". Making it a leaf." << std::endl;
+            top.node->children = {};
+            continue;
+        }
+        top.node->leaf = false;
+        top.node->splitOrder = static_cast<int>(leavesAfterSplit.size());
+        leaves += created - 1;
+        leavesAfterSplit.push_back(leaves);
+        nodeCount += created;
+        maxDepth = std::max(maxDepth, top.depth + 1);
+
+        for (const auto& child : top.node->children) {
+            if (child) {
+                consider(child.get(), top.depth + 1);
+            }
+        }
+    }
+}
+
+namespace {
+
+// Satu simpul pada pemangkasan RD. "Sub" adalah nilai subpohon yang masih tersisa.
+struct PruneRecord {
+    QuadTreeNode* node;
+    int parent;
+    std::array<int, 4> children;
+    double leafDistortion;
+    double subDistortion;
+    double subRate;
+    bool internal;
+    bool removed;
+    unsigned version;
+};
+
+} // namespace
+
+// Generalized BFOS: simpul internal dengan kemiringan (D_leaf - D_sub) / (R_sub - R_leaf)
+// terkecil dipangkas lebih dulu. Kemiringan pada saat dipangkas adalah breakpoint lambda;
+// pohon optimal untuk lambda apa pun adalah awalan urutan ini, jadi lambda (atau target rate)
+// dipilih langsung dari daftar breakpoint tanpa membangun ulang pohon.
+void Quadtree::pruneRateDistortion() {
+    if (!rootNode) {
+        return;
+    }
+    const double leafRate = NodeFlagBits + LeafColorBits + (leafModel == LeafModel::PLANE ? LeafGradientBits : 0.0);
+
+    std::vector<PruneRecord> records;
+    records.reserve(nodeCount);
+    std::vector<std::pair<QuadTreeNode*, int>> stack{{rootNode.get(), -1}};
+    while (!stack.empty()) {
+        auto [node, parent] = stack.back();
+        stack.pop_back();
+        const int index = static_cast<int>(records.size());
+        const double area = static_cast<double>(node->width) * node->height;
+        records.push_back(PruneRecord{node, parent, {-1, -1, -1, -1},
+                                      nodeError(*node) * area, 0.0, 0.0,
+                                      !node->leaf, false, 0});
+        if (parent >= 0) {
+            auto& siblings = records[parent].children;
+            *std::find(siblings.begin(), siblings.end(), -1) = index;
+        }
+        for (const auto& child : node->children) {
+            if (child) {
+                stack.emplace_back(child.get(), index);
+            }
+        }
+    }
+
+    // Anak selalu berada setelah induknya, jadi iterasi mundur menghasilkan nilai subpohon
+    for (auto it = records.rbegin(); it != records.rend(); ++it) {
+        if (!it->internal) {
+            it->subDistortion = it->leafDistortion;
+            it->subRate = leafRate;
+            continue;
+        }
+        it->subDistortion = 0.0;
+        it->subRate = NodeFlagBits;
+        for (int child : it->children) {
+            if (child >= 0) {
+                it->subDistortion += records[child].subDistortion;
+                it->subRate += records[child].subRate;
+            }
+        }
+    }
+
+    const double fullRate = records[0].subRate;
+    const double fullDistortion = records[0].subDistortion;
+
+    auto slope = [&](const PruneRecord& r) {
+        return (r.leafDistortion - r.subDistortion) / (r.subRate - leafRate);
+    };
+    struct Entry {
+        double slope;
+        int index;
+        unsigned version;
+    };
+    auto steeper = [](const Entry& a, const Entry& b) {
+        return a.slope != b.slope ? a.slope > b.slope : a.index > b.index;
+    };
+    std::priority_queue<Entry, std::vector<Entry>, decltype(steeper)> heap(steeper);
+    for (size_t i = 0; i < records.size(); ++i) {
+        if (records[i].internal) {
+            heap.push(Entry{slope(records[i]), static_cast<int>(i), 0});
+        }
+    }
+
+    struct Step {
+        QuadTreeNode* node;
+        double lambda;
+        double rate;
+        double distortion;
+    };
+    std::vector<Step> steps;
+    double breakpoint = 0.0; // lambda negatif tidak bermakna; pemangkasan yang menurunkan D terjadi pada 0
+    while (!heap.empty()) {
+        const Entry top = heap.top();
+        heap.pop();
+        PruneRecord& record = records[top.index];
+        if (record.removed || !record.internal || record.version != top.version) {
+            continue;
+        }
+
+        breakpoint = std::max(breakpoint, top.slope);
+        const double deltaD = record.leafDistortion - record.subDistortion;
+        const double deltaR = leafRate - record.subRate;
+        record.internal = false;
+        record.subDistortion = record.leafDistortion;
+        record.subRate = leafRate;
+
+        std::vector<int> descendants(record.children.begin(), record.children.end());
+        while (!descendants.empty()) {
+            const int d = descendants.back();
+            descendants.pop_back();
+            if (d < 0 || records[d].removed) {
+                continue;
+            }
+            records[d].removed = true;
+            descendants.insert(descendants.end(), records[d].children.begin(), records[d].children.end());
+        }
+        for (int a = record.parent; a >= 0; a = records[a].parent) {
+            records[a].subDistortion += deltaD;
+            records[a].subRate += deltaR;
+            heap.push(Entry{slope(records[a]), a, ++records[a].version});
+        }
+        steps.push_back(Step{record.node, breakpoint, records[0].subRate, records[0].subDistortion});
+    }
+
+    // Banyaknya pemangkasan: semua breakpoint <= lambda, atau awalan terpendek yang memenuhi target rate
+    size_t pruneCount = 0;
+    if (targetRateBits > 0.0) {
+        if (fullRate > targetRateBits) {
+            const auto reached = std::partition_point(steps.begin(), steps.end(),
+                [&](const Step& s) { return s.rate > targetRateBits; });
+            pruneCount = std::min(steps.size(), static_cast<size_t>(reached - steps.begin()) + 1);
+        }
+        lambda = pruneCount > 0 ? steps[pruneCount - 1].lambda : 0.0;
+    } else {
+        pruneCount = static_cast<size_t>(std::partition_point(steps.begin(), steps.end(),
+            [&](const Step& s) { return s.lambda <= lambda; }) - steps.begin());
+    }
+
+    // Simpul yang dipangkas belakangan bisa menjadi leluhur simpul sebelumnya; anak yang
+    // dilepas lebih dulu tidak pernah disentuh lagi
+    for (size_t k = 0; k < pruneCount; ++k) {
+        steps[k].node->leaf = true;
+        steps[k].node->children = {};
+    }
+    recountNodes();
+    rateBits = pruneCount > 0 ? steps[pruneCount - 1].rate : fullRate;
+    distortion = pruneCount > 0 ? steps[pruneCount - 1].distortion : fullDistortion;
+}
+
+// Menghitung ulang jumlah simpul dan kedalaman setelah pohon dipangkas
+void Quadtree::recountNodes() {
+    nodeCount = 0;
+    maxDepth = 0;
+    std::vector<std::pair<const QuadTreeNode*, int>> stack{{rootNode.get(), 1}};
+    while (!stack.empty()) {
+        auto [node, depth] = stack.back();
+        stack.pop_back();
+        ++nodeCount;
+        maxDepth = std::max(maxDepth, depth);
+        for (const auto& child : node->children) {
+            if (child) {
+                stack.emplace_back(child.get(), depth + 1);
+            }
+        }
+    }
+    allocatedNodes = nodeCount;
+}
+
+size_t Quadtree::getLeafCountAfterSplits(size_t splits) const {
+    if (splits == 0 || leavesAfterSplit.empty()) {
+        return 1;
+    }
+    return leavesAfterSplit[std::min(splits, leavesAfterSplit.size()) - 1];
+}
+
+Image Quadtree::reconstructImageAfterSplits(size_t splits) const {
+    if (buildMode != BuildMode::BEST_FIRST) {
+        throw std::logic_error("reconstructImageAfterSplits hanya tersedia untuk pohon BEST_FIRST.");
+    }
+    Image reconstructed(imageWidth, imageHeight);
+    const int limit = static_cast<int>(std::min(splits, leavesAfterSplit.size()));
+    rootNode->reconstructRegionSplits(reconstructed, limit);
+    return reconstructed;
+}
+
 Image Quadtree::reconstructImage() const {
     if (!rootNode) {
         std::cerr << "Warning: reconstructImage called on uninitialized Quadtree. Returning empty image." << std::endl;
         return Image(0, 0);
     }
     Image reconstructed(imageWidth, imageHeight);
-    rootNode->reconstructRegion(reconstructed);
+    Trace::Scope trace("reconstruct", "reconstruct");
+    if (Trace::enabled() && !rootNode->isLeaf()) {
+        // Setiap kuadran tingkat atas dicatat sebagai satu tile pada trace
+        for (int i = 0; i < 4; ++i) {
+            if (rootNode->children[i]) {
+                Trace::Scope tile("reconstruct", "tile " + std::to_string(i));
+                rootNode->children[i]->reconstructRegion(reconstructed);
+            }
+        }
+    } else {
+        rootNode->reconstructRegion(reconstructed);
+    }
+    return reconstructed;
+}
+
+Image Quadtree::reconstructImage(int maxDepth) const {
+    if (!rootNode) {
+        std::cerr << "Warning: reconstructImage called on uninitialized Quadtree. Returning empty image." << std::endl;
+        return Image(0, 0);
+    }
+    Image reconstructed(imageWidth, imageHeight);
+    rootNode->reconstructRegion(reconstructed, std::max(1, maxDepth), 1);
     return reconstructed;
 }
 
@@ -457,4 +1183,111 @@ void Quadtree::getAllNodes(std::vector<const QuadTreeNode*>& nodes) const {
 }
 
 int Quadtree::getDepth() const { return maxDepth; }
-size_t Quadtree::getNodeCount() const { return nodeCount; }
\ No newline at end of file
+size_t Quadtree::getNodeCount() const { return nodeCount; }
+
+std::vector<size_t> Quadtree::getLeafDepthHistogram() const {
+    std::vector<size_t> histogram(static_cast<size_t>(std::max(0, maxDepth)), 0);
+    if (!rootNode) {
+        return histogram;
+    }
+
+    // Traversal iteratif agar pohon yang dalam tidak menghabiskan stack
+    std::vector<std::pair<const QuadTreeNode*, int>> stack;
+    stack.emplace_back(rootNode.get(), 1);
+    while (!stack.empty()) {
+        auto [node, depth] = stack.back();
+        stack.pop_back();
+        if (node->isLeaf()) {
+            if (static_cast<size_t>(depth) > histogram.size()) {
+                histogram.resize(depth, 0);
+            }
+            histogram[depth - 1]++;
+            continue;
+        }
+        for (const auto& child : node->getChildren()) {
+            if (child) {
+                stack.emplace_back(child.get(), depth + 1);
+            }
+        }
+    }
+    return histogram;
+}
+
+size_t Quadtree::getLeafCount() const {
+    std::vector<size_t> histogram = getLeafDepthHistogram();
+    return std::accumulate(histogram.begin(), histogram.end(), size_t{0});
+}
+
+double Quadtree::psnrFromSquaredError(double squaredError, size_t pixelCount) {
+    if (squaredError <= 0.0 || pixelCount == 0) {
+        return 99.0; // rekonstruksi identik; batas yang sama dengan golden test
+    }
+    const double mse = squaredError / (3.0 * static_cast<double>(pixelCount));
+    return 10.0 * std::log10(255.0 * 255.0 / mse);
+}
+
+void Quadtree::accumulateLeafQuality(double& squaredError, double& ssimArea) const {
+    squaredError = 0.0;
+    ssimArea = 0.0;
+    std::vector<const QuadTreeNode*> stack;
+    if (rootNode) {
+        stack.push_back(rootNode.get());
+    }
+    while (!stack.empty()) {
+        const QuadTreeNode* node = stack.back();
+        stack.pop_back();
+        if (node->isLeaf()) {
+            squaredError += node->getSquaredError();
+            ssimArea += node->getSSIM() * node->getWidth() * node->getHeight();
+            continue;
+        }
+        for (const auto& child : node->getChildren()) {
+            if (child) {
+                stack.push_back(child.get());
+            }
+        }
+    }
+}
+
+double Quadtree::getSquaredError() const {
+    double squaredError = 0.0, ssimArea = 0.0;
+    accumulateLeafQuality(squaredError, ssimArea);
+    return squaredError;
+}
+
+double Quadtree::getPSNR() const {
+    return psnrFromSquaredError(getSquaredError(), static_cast<size_t>(imageWidth) * imageHeight);
+}
+
+double Quadtree::getSSIM() const {
+    double squaredError = 0.0, ssimArea = 0.0;
+    accumulateLeafQuality(squaredError, ssimArea);
+    const double area = static_cast<double>(imageWidth) * imageHeight;
+    return area > 0.0 ? ssimArea / area : 1.0;
+}
+
+
+size_t Quadtree::bytesPerNode() {
+    // unique_ptr dialokasikan satu per simpul; alokator umum menambah sekitar dua pointer per blok
+    return sizeof(QuadTreeNode) + 2 * sizeof(void*);
+}
+
+size_t Quadtree::worstCaseTreeBytes(int width, int height, int minBlockSize) {
+    const size_t pixelCount = static_cast<size_t>(std::max(0, width)) * static_cast<size_t>(std::max(0, height));
+    const size_t leaves = pixelCount / static_cast<size_t>(std::max(1, minBlockSize)) + 1;
+    return (leaves * 4 / 3 + 1) * bytesPerNode();
+}
+
+size_t Quadtree::regionStatsBytes(int width, int height, SplitMode splitMode, LeafModel leafModel) {
+    if (splitMode != SplitMode::ADAPTIVE && leafModel != LeafModel::PLANE) {
+        return 0;
+    }
+    return RegionStats::bytesFor(width, height, leafModel == LeafModel::PLANE);
+}
+
+size_t Quadtree::getMemoryUsage() const {
+    // Entri rentang warna leaf gabungan: pasangan kunci/nilai ditambah node dan bucket hash
+    const size_t rangeBytes = mergedColorRanges.size() *
+        (sizeof(std::pair<const QuadTreeNode* const, ColorRange>) + 2 * sizeof(void*));
+    return allocatedNodes * bytesPerNode() + (regionStats ? regionStats->getMemoryUsage() : 0) + rangeBytes;
+}
\ No newline at end of file
@@ -2,12 +2,14 @@
 #define QUADTREE_H
 
 #include "Image.h" 
+#include "RegionStats.h"
 #include <vector>
 #include <memory> 
 #include <array>  
 #include <string> 
 #include <stdexcept> 
 #include <limits>    
+#include <unordered_map>
 
 class Quadtree;
 
@@ -19,17 +21,77 @@ enum class ErrorMetric {
     SSIM
 };
 
+enum class BuildMode {
+    DEPTH_FIRST, // split rekursif setiap simpul yang error-nya di atas threshold
+    BEST_FIRST,  // selalu split leaf dengan error terbesar sampai batas leaf atau threshold tercapai
+    RATE_DISTORTION // pohon penuh dibangun sekali lalu dipangkas dengan biaya D + lambda x R
+};
+
+enum class SplitMode {
+    QUAD,     // setiap split membagi blok menjadi empat
+    ADAPTIVE  // split empat, horizontal, atau vertikal; dipilih per blok
+};
+
+enum class LeafModel {
+    FLAT,  // leaf = satu warna rata-rata
+    PLANE  // leaf = bidang warna per channel: rata-rata + gradien x dan y (least squares)
+};
+
+// Pengaturan tambahan pembentukan pohon
+struct QuadtreeOptions {
+    // Batas memori simpul pohon dalam byte (0 = tanpa batas). Untuk DEPTH_FIRST, jika pohon
+    // melebihi batas, pembentukan diulang dengan minBlockSize yang diperbesar 4x sampai muat;
+    // untuk BEST_FIRST, split berhenti saat batas tercapai.
+    size_t memoryBudgetBytes = 0;
+
+    BuildMode buildMode = BuildMode::DEPTH_FIRST;
+    size_t maxLeaves = 0;       // batas jumlah leaf untuk BEST_FIRST (0 = hanya dibatasi threshold)
+    bool weightByArea = true;   // prioritas BEST_FIRST = error x luas; false = error saja
+
+    // RATE_DISTORTION: pemangkasan berhenti pada lambda ini (distorsi per bit), atau pada
+    // pemangkasan paling sedikit yang membuat estimasi rate <= targetRateBits jika diisi (> 0)
+    double lambda = 0.0;
+    double targetRateBits = 0.0;
+
+    // ADAPTIVE: pembagian dengan penurunan jumlah kuadrat error per leaf tambahan terbesar
+    // (split dua menambah 1 leaf, split empat menambah 3). Berlaku untuk semua BuildMode;
+    // split dua hanya mengisi children[0] dan children[1].
+    SplitMode splitMode = SplitMode::QUAD;
+
+    // Setelah pohon dibentuk, anak-anak leaf digabung kembali ke induknya, berulang dari bawah
+    // ke atas, jika semua warna leaf asli di bawah induk berselisih paling banyak nilai ini
+    // (per channel) dari warna induk. Negatif = nonaktif; 0 = hanya warna yang identik.
+    int mergeTolerance = -1;
+
+    // PLANE: gradien dihitung O(1) dari momen pertama pada tabel jumlah, dan metrik error
+    // (variance, mad, max) diukur terhadap bidang tersebut. Entropi dan SSIM tidak didukung.
+    LeafModel leafModel = LeafModel::FLAT;
+};
+
+// Rentang warna leaf asli (sebelum penggabungan) per channel di bawah satu leaf
+struct ColorRange {
+    Pixel low;
+    Pixel high;
+};
+
 class QuadTreeNode {
 private:
     // Data Anggota
     int x, y;                   
     int width, height;          
     Pixel averageColor;         
+    std::array<float, 3> squaredError{}; // jumlah kuadrat selisih terhadap model leaf per channel (R, G, B)
+    std::array<float, 3> gradientX{};    // PLANE: perubahan warna per piksel ke kanan dan ke bawah,
+    std::array<float, 3> gradientY{};    // relatif terhadap pusat blok; nol untuk FLAT
+    std::array<float, 3> meanOffset{};   // PLANE: rata-rata tepat dikurangi averageColor (pusat bidang tidak dibulatkan)
     bool leaf;                  
+    int splitOrder = -1;        // urutan split pada BEST_FIRST; -1 jika tidak di-split atau DEPTH_FIRST
     std::array<std::unique_ptr<QuadTreeNode>, 4> children; 
     const Image& sourceImage;   
 
-    Pixel calculateAverageColor() const;              
+    Pixel calculateAverageColor(std::array<float, 3>& channelSquaredError) const;
+    static Pixel colorFromSums(const long long sum[3], const long long sumSq[3], long long count,
+                               std::array<float, 3>& channelSquaredError);
     double calculateError(ErrorMetric metric) const;  
 
     static double calculateVarianceInternal(const Image& img, int x, int y, int w, int h);
@@ -37,11 +99,18 @@ private:
     static double calculateMaxPixelDifferenceInternal(const Image& img, int x, int y, int w, int h);
     static double calculateEntropyInternal(const Image& img, int x, int y, int w, int h);
     double calculateSSIMInternal(const Image& img, int x, int y, int w, int h) const;
+    // MAD atau max pixel difference terhadap bidang warna leaf, bukan terhadap rata-rata
+    double calculatePlaneResidualError(ErrorMetric metric) const;
 
     friend class Quadtree;
+    friend class ThresholdSweep;
 
 public:
     QuadTreeNode(int x, int y, int width, int height, const Image& image);
+    // Warna rata-rata dan error kuadrat diambil dari tabel jumlah dalam O(1), hasilnya sama.
+    // fitPlane: gradien bidang warna juga dihitung (tabel harus menyimpan momen).
+    QuadTreeNode(int x, int y, int width, int height, const Image& image, const RegionStats& stats,
+                 bool fitPlane = false);
 
     bool isLeaf() const { return leaf; }
     Pixel getAverageColor() const { return averageColor; }
@@ -49,11 +118,22 @@ public:
     int getY() const { return y; }
     int getWidth() const { return width; }
     int getHeight() const { return height; }
+    // Jumlah kuadrat selisih semua channel jika blok ini menjadi leaf (dihitung saat simpul dibuat)
+    double getSquaredError() const;
+    // SSIM blok terhadap model leaf-nya, dirata-rata atas channel
+    double getSSIM() const;
+    bool hasGradient() const;
+    // Melukis blok ini (warna rata atau bidang warna) ke targetImage, dipotong ke batas gambar
+    void paint(Image& targetImage) const;
     const std::array<std::unique_ptr<QuadTreeNode>, 4>& getChildren() const { return children; }
 
     void collectNodes(std::vector<const QuadTreeNode*>& nodes) const;
 
     void reconstructRegion(Image& targetImage) const;
+    // Sama seperti reconstructRegion, tetapi node pada kedalaman maxDepth dianggap leaf
+    void reconstructRegion(Image& targetImage, int maxDepth, int currentDepth) const;
+    // Sama seperti reconstructRegion, tetapi hanya split dengan splitOrder < splitLimit yang dipakai
+    void reconstructRegionSplits(Image& targetImage, int splitLimit) const;
 };
 
 
@@ -71,17 +151,105 @@ private:
     size_t nodeCount; 
     int maxDepth;    
 
+    size_t memoryBudgetBytes;
+    size_t allocatedNodes = 0;     // simpul yang sudah dibuat pada percobaan build saat ini
+    bool budgetExceeded = false;
+    int requestedMinBlockSize;
+
+    BuildMode buildMode;
+    size_t maxLeaves;
+    bool weightByArea;
+    std::vector<size_t> leavesAfterSplit; // BEST_FIRST: jumlah leaf setelah split ke-k (indeks k-1)
+
+    double lambda;
+    double targetRateBits;
+    double rateBits = 0.0;    // RATE_DISTORTION: estimasi rate dan distorsi pohon setelah dipangkas
+    double distortion = 0.0;
+
+    SplitMode splitMode;
+    std::unique_ptr<RegionStats> regionStats; // ADAPTIVE/PLANE: statistik persegi panjang O(1)
+    enum class SplitKind { QUAD, HORIZONTAL, VERTICAL, NONE };
+
+    int mergeTolerance;
+    // Leaf hasil penggabungan saudara: rentang warna leaf asli yang digantikannya
+    std::unordered_map<const QuadTreeNode*, ColorRange> mergedColorRanges;
+    LeafModel leafModel;
+
+    SplitKind chooseSplit(const QuadTreeNode& node) const; // NONE jika simpul tidak boleh dibagi
+    static size_t childCountOf(const QuadTreeNode& node, SplitKind kind);
+    std::unique_ptr<QuadTreeNode> makeNode(int x, int y, int width, int height) const;
+    size_t createChildren(QuadTreeNode* node, SplitKind kind);
+    void build();
     void buildRecursive(QuadTreeNode* node, int currentDepth);
+    void buildBestFirst();
+    void pruneRateDistortion();
+    void recountNodes();
+    void mergeSimilarSiblings();
+    // true jika simpul menjadi leaf; range diisi rentang warna leaf asli di bawah simpul
+    bool mergeSiblingsRecursive(QuadTreeNode* node, ColorRange& range);
+    void accumulateLeafQuality(double& squaredError, double& ssimArea) const;
 
 public:
+    // threshold negatif membangun pohon penuh sampai minSize tanpa menghitung error
     Quadtree(const Image& image, ErrorMetric metric, double threshold, int minSize);
+    Quadtree(const Image& image, ErrorMetric metric, double threshold, int minSize,
+             const QuadtreeOptions& options);
+
+    // Perkiraan byte per simpul di heap, termasuk overhead alokator
+    static size_t bytesPerNode();
+    // Perkiraan jumlah byte simpul pohon terburuk (pohon penuh dengan leaf seluas minBlockSize)
+    static size_t worstCaseTreeBytes(int width, int height, int minBlockSize);
+    // Byte tabel RegionStats yang dibuat pohon dengan mode ini (0 untuk QUAD + FLAT)
+    static size_t regionStatsBytes(int width, int height, SplitMode splitMode, LeafModel leafModel);
 
     Image reconstructImage() const;
+    // Rekonstruksi pohon yang dipotong pada kedalaman tertentu (root = kedalaman 1)
+    Image reconstructImage(int maxDepth) const;
+
+    // BEST_FIRST: pohon dengan k split pertama adalah awalan dari pohon penuh, sehingga
+    // ukuran lain dapat direkonstruksi tanpa membangun ulang pohon
+    size_t getSplitCount() const { return leavesAfterSplit.size(); }
+    size_t getLeafCountAfterSplits(size_t splits) const;
+    Image reconstructImageAfterSplits(size_t splits) const;
+
+    // Model rate RATE_DISTORTION: pohon diserialisasi preorder dengan 1 bit penanda per simpul
+    // dan warna 24 bit per leaf; leaf PLANE menambah gradien x dan y per channel (8 bit
+    // masing-masing). Distorsi satu leaf = error metrik x luas blok.
+    static constexpr double NodeFlagBits = 1.0;
+    static constexpr double LeafColorBits = 24.0;
+    static constexpr double LeafGradientBits = 48.0;
+    double getRateBits() const { return rateBits; }
+    double getDistortion() const { return distortion; }
+    // Lambda pemangkasan yang dipakai (untuk target rate: breakpoint yang terpilih)
+    double getLambda() const { return lambda; }
+
+    // Error metrik simpul pohon ini; varians diambil dari tabel jumlah jika tersedia (ADAPTIVE)
+    double nodeError(const QuadTreeNode& node) const;
 
     int getDepth() const;
     size_t getNodeCount() const;
+    size_t getLeafCount() const;
+
+    // Kualitas rekonstruksi terhadap gambar sumber, dari SSE dan statistik per leaf yang
+    // disimpan saat pembentukan; tidak perlu merekonstruksi dan membandingkan gambar
+    double getSquaredError() const; // jumlah kuadrat error semua leaf, semua channel
+    double getPSNR() const;
+    double getSSIM() const;  // SSIM leaf dirata-rata berbobot luas
+    static double psnrFromSquaredError(double squaredError, size_t pixelCount);
+
+    // Byte simpul pohon ditambah tabel RegionStats (48-96 byte per piksel pada ADAPTIVE/PLANE)
+    // dan rentang warna leaf hasil penggabungan.
+    // Batas memori pohon hanya membatasi simpul; ukuran tabel tetap untuk satu gambar.
+    size_t getMemoryUsage() const;
+    // minBlockSize yang benar-benar dipakai; lebih besar dari yang diminta jika dibatasi memori
+    int getEffectiveMinBlockSize() const { return minimumBlockSize; }
+    bool isBudgetLimited() const { return minimumBlockSize != requestedMinBlockSize; }
+    // Jumlah leaf per kedalaman; indeks 0 = kedalaman 1 (root)
+    std::vector<size_t> getLeafDepthHistogram() const;
 
     const QuadTreeNode* getRoot() const { return rootNode.get(); }
+    // Rentang warna leaf asli di bawah leaf ini; [warna, warna] jika tidak hasil penggabungan
+    ColorRange leafColorRange(const QuadTreeNode& leaf) const;
     void getAllNodes(std::vector<const QuadTreeNode*>& nodes) const;
 
 };
@@ -0,0 +1,139 @@
+#include "RegionMerge.h"
+#include "Trace.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <tuple>
+
+namespace {
+
+// Wilayah sementara: jumlah warna x luas disimpan agar rata-rata gabungan tetap tepat,
+// jumlah warna^2 x luas untuk menghitung selisih warna leaf terhadap warna wilayah, dan
+// rentang warna leaf asli (termasuk leaf yang sudah digabung di pohon) di dalam wilayah
+struct WorkRegion {
+    int x, y, width, height;
+    double sum[3];
+    double sumSq[3];
+    int low[3];
+    int high[3];
+
+    double area() const { return static_cast<double>(width) * height; }
+    int channel(int c) const { return static_cast<int>(std::lround(sum[c] / area())); }
+};
+
+// Warna wilayah gabungan harus tetap dalam tolerance dari setiap warna leaf asli di kedua
+// wilayah, sehingga penggabungan berulang tidak membuat warna wilayah bergeser terus
+bool withinTolerance(const WorkRegion& a, const WorkRegion& b, int tolerance) {
+    const double area = a.area() + b.area();
+    for (int c = 0; c < 3; ++c) {
+        const int merged = static_cast<int>(std::lround((a.sum[c] + b.sum[c]) / area));
+        if (merged - std::min(a.low[c], b.low[c]) > tolerance || std::max(a.high[c], b.high[c]) - merged > tolerance) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Satu arah penggabungan. horizontal: baris & tinggi sama, bersebelahan di x;
+// vertikal: kolom & lebar sama, bersebelahan di y.
+std::vector<WorkRegion> mergePass(std::vector<WorkRegion> regions, bool horizontal, int tolerance) {
+    std::sort(regions.begin(), regions.end(), [horizontal](const WorkRegion& a, const WorkRegion& b) {
+        if (horizontal) {
+            return std::tie(a.y, a.height, a.x) < std::tie(b.y, b.height, b.x);
+        }
+        return std::tie(a.x, a.width, a.y) < std::tie(b.x, b.width, b.y);
+    });
+    std::vector<WorkRegion> merged;
+    merged.reserve(regions.size());
+    for (const WorkRegion& r : regions) {
+        if (!merged.empty()) {
+            WorkRegion& last = merged.back();
+            const bool adjacent = horizontal
+                ? (last.y == r.y && last.height == r.height && last.x + last.width == r.x)
+                : (last.x == r.x && last.width == r.width && last.y + last.height == r.y);
+            if (adjacent && withinTolerance(last, r, tolerance)) {
+                (horizontal ? last.width : last.height) += horizontal ? r.width : r.height;
+                for (int c = 0; c < 3; ++c) {
+                    last.sum[c] += r.sum[c];
+                    last.sumSq[c] += r.sumSq[c];
+                    last.low[c] = std::min(last.low[c], r.low[c]);
+                    last.high[c] = std::max(last.high[c], r.high[c]);
+                }
+                continue;
+            }
+        }
+        merged.push_back(r);
+    }
+    return merged;
+}
+
+} // namespace
+
+std::vector<LeafRegion> RegionMerge::fromTree(const Quadtree& tree, int tolerance, double* addedSquaredError) {
+    Trace::Scope trace("reconstruct", "merge regions");
+    std::vector<WorkRegion> regions;
+    std::vector<const QuadTreeNode*> stack;
+    if (tree.getRoot()) {
+        stack.push_back(tree.getRoot());
+    }
+    while (!stack.empty()) {
+        const QuadTreeNode* node = stack.back();
+        stack.pop_back();
+        if (!node->isLeaf()) {
+            for (const auto& child : node->getChildren()) {
+                if (child) {
+                    stack.push_back(child.get());
+                }
+            }
+            continue;
+        }
+        const Pixel color = node->getAverageColor();
+        const ColorRange range = tree.leafColorRange(*node);
+        const double area = static_cast<double>(node->getWidth()) * node->getHeight();
+        const double rgb[3] = {static_cast<double>(color.r), static_cast<double>(color.g), static_cast<double>(color.b)};
+        regions.push_back(WorkRegion{node->getX(), node->getY(), node->getWidth(), node->getHeight(),
+                                     {rgb[0] * area, rgb[1] * area, rgb[2] * area},
+                                     {rgb[0] * rgb[0] * area, rgb[1] * rgb[1] * area, rgb[2] * rgb[2] * area},
+                                     {range.low.r, range.low.g, range.low.b},
+                                     {range.high.r, range.high.g, range.high.b}});
+    }
+    trace.arg("leaves", static_cast<double>(regions.size()));
+
+    // Setiap putaran hanya bisa mengurangi jumlah wilayah, jadi perulangan pasti berhenti
+    for (size_t previous = 0; previous != regions.size();) {
+        previous = regions.size();
+        regions = mergePass(std::move(regions), true, tolerance);
+        regions = mergePass(std::move(regions), false, tolerance);
+    }
+
+    std::vector<LeafRegion> result;
+    result.reserve(regions.size());
+    double added = 0.0;
+    for (const WorkRegion& r : regions) {
+        // sum luas x (a - m)^2 = sum luas x a^2 - 2m sum luas x a + m^2 x luas
+        for (int c = 0; c < 3; ++c) {
+            const double m = r.channel(c);
+            added += r.sumSq[c] - 2.0 * m * r.sum[c] + m * m * r.area();
+        }
+        result.push_back(LeafRegion{r.x, r.y, r.width, r.height,
+                                    Pixel(static_cast<unsigned char>(r.channel(0)), static_cast<unsigned char>(r.channel(1)),
+                                          static_cast<unsigned char>(r.channel(2)))});
+    }
+    if (addedSquaredError) {
+        *addedSquaredError = std::max(0.0, added);
+    }
+    trace.arg("regions", static_cast<double>(result.size()));
+    return result;
+}
+
+Image RegionMerge::reconstruct(int width, int height, const std::vector<LeafRegion>& regions) {
+    Trace::Scope trace("reconstruct", "paint regions");
+    Image image(width, height);
+    std::vector<Pixel>& pixels = image.getPixelData();
+    for (const LeafRegion& r : regions) {
+        for (int i = r.y; i < r.y + r.height; ++i) {
+            std::fill_n(pixels.begin() + static_cast<size_t>(i) * width + r.x, r.width, r.color);
+        }
+    }
+    return image;
+}
@@ -0,0 +1,30 @@
+#ifndef REGIONMERGE_H
+#define REGIONMERGE_H
+
+#include <vector>
+#include "Image.h"
+#include "QuadTree.h"
+
+// Satu persegi panjang warna rata pada gambar keluaran
+struct LeafRegion {
+    int x, y;
+    int width, height;
+    Pixel color;
+};
+
+// Penggabungan leaf bertetangga lintas induk menjadi persegi panjang yang lebih besar.
+// Leaf dengan tinggi dan baris yang sama digabung ke kanan, lalu potongan dengan lebar dan
+// kolom yang sama digabung ke bawah, diulang sampai tidak ada perubahan. Warna wilayah adalah
+// rata-rata berbobot luas; dua wilayah hanya bergabung jika warna gabungannya berselisih paling
+// banyak tolerance per channel dari setiap warna leaf asli di dalamnya (termasuk leaf yang sudah
+// digabung saudara di pohon, lihat Quadtree::leafColorRange), sehingga selisih piksel keluaran
+// terhadap pohon tanpa penggabungan tidak pernah melebihi tolerance (0 = hasil sama persis).
+class RegionMerge {
+public:
+    // addedSquaredError (opsional): tambahan jumlah kuadrat error terhadap gambar sumber karena
+    // warna leaf diganti warna wilayahnya (sum luas x selisih warna^2)
+    static std::vector<LeafRegion> fromTree(const Quadtree& tree, int tolerance, double* addedSquaredError = nullptr);
+    static Image reconstruct(int width, int height, const std::vector<LeafRegion>& regions);
+};
+
+#endif // REGIONMERGE_H
@@ -0,0 +1,115 @@
+#include "RegionStats.h"
+#include <algorithm>
+
+namespace {
+
+// Jumlah empat sudut persegi panjang pada tabel kumulatif. Aritmetika unsigned modular:
+// hasil akhir selalu nonnegatif sehingga tetap tepat.
+template <typename Row>
+Row rectFromTable(const std::vector<Row>& table, int stride, int x, int y, int width, int height) {
+    Row result{};
+    if (width <= 0 || height <= 0) {
+        return result;
+    }
+    const Row& a = table[static_cast<size_t>(y) * stride + x];
+    const Row& b = table[static_cast<size_t>(y) * stride + x + width];
+    const Row& c = table[static_cast<size_t>(y + height) * stride + x];
+    const Row& d = table[static_cast<size_t>(y + height) * stride + x + width];
+    for (size_t k = 0; k < result.size(); ++k) {
+        result[k] = d[k] - b[k] - c[k] + a[k];
+    }
+    return result;
+}
+
+} // namespace
+
+RegionStats::RegionStats(const Image& image, bool withMoments)
+    : stride(image.getWidth() + 1),
+      table(static_cast<size_t>(image.getWidth() + 1) * (image.getHeight() + 1), Sums{}) {
+    if (withMoments) {
+        momentTable.assign(table.size(), Moments{});
+    }
+    const int width = image.getWidth();
+    const std::vector<Pixel>& pixels = image.getPixelData();
+    for (int i = 0; i < image.getHeight(); ++i) {
+        Sums row{};
+        const Pixel* source = pixels.data() + static_cast<size_t>(i) * width;
+        const Sums* above = table.data() + static_cast<size_t>(i) * stride;
+        Sums* current = table.data() + static_cast<size_t>(i + 1) * stride;
+        for (int j = 0; j < width; ++j) {
+            const uint64_t value[3] = {source[j].r, source[j].g, source[j].b};
+            for (int c = 0; c < 3; ++c) {
+                row[c] += value[c];
+                row[c + 3] += value[c] * value[c];
+            }
+            for (int k = 0; k < 6; ++k) {
+                current[j + 1][k] = above[j + 1][k] + row[k];
+            }
+        }
+    }
+    if (!withMoments) {
+        return;
+    }
+    for (int i = 0; i < image.getHeight(); ++i) {
+        Moments row{};
+        const Pixel* source = pixels.data() + static_cast<size_t>(i) * width;
+        const Moments* above = momentTable.data() + static_cast<size_t>(i) * stride;
+        Moments* current = momentTable.data() + static_cast<size_t>(i + 1) * stride;
+        for (int j = 0; j < width; ++j) {
+            const uint64_t value[3] = {source[j].r, source[j].g, source[j].b};
+            for (int c = 0; c < 3; ++c) {
+                row[c] += static_cast<uint64_t>(j) * value[c];
+                row[c + 3] += static_cast<uint64_t>(i) * value[c];
+            }
+            for (int k = 0; k < 6; ++k) {
+                current[j + 1][k] = above[j + 1][k] + row[k];
+            }
+        }
+    }
+}
+
+size_t RegionStats::bytesFor(int width, int height, bool withMoments) {
+    const size_t cells = static_cast<size_t>(std::max(0, width) + 1) * static_cast<size_t>(std::max(0, height) + 1);
+    return cells * (sizeof(Sums) + (withMoments ? sizeof(Moments) : 0));
+}
+
+size_t RegionStats::getMemoryUsage() const {
+    return table.capacity() * sizeof(Sums) + momentTable.capacity() * sizeof(Moments);
+}
+
+RegionStats::Sums RegionStats::rectSums(int x, int y, int width, int height) const {
+    return rectFromTable(table, stride, x, y, width, height);
+}
+
+RegionStats::Moments RegionStats::rectMoments(int x, int y, int width, int height) const {
+    return rectFromTable(momentTable, stride, x, y, width, height);
+}
+
+double RegionStats::squaredError(int x, int y, int width, int height) const {
+    if (width <= 0 || height <= 0) {
+        return 0.0;
+    }
+    const Sums sums = rectSums(x, y, width, height);
+    const double n = static_cast<double>(width) * height;
+    double error = 0.0;
+    for (int c = 0; c < 3; ++c) {
+        const double sum = static_cast<double>(sums[c]);
+        error += static_cast<double>(sums[c + 3]) - sum * sum / n;
+    }
+    if (hasMoments()) {
+        // Fit bidang: x dan y terpusat saling ortogonal, jadi tiap sumbu mengurangi SSE sebesar
+        // (sum (x - cx) p)^2 / sum (x - cx)^2
+        const Moments moments = rectMoments(x, y, width, height);
+        const double cx = x + (width - 1) / 2.0;
+        const double cy = y + (height - 1) / 2.0;
+        const double sxx = n * (static_cast<double>(width) * width - 1.0) / 12.0;
+        const double syy = n * (static_cast<double>(height) * height - 1.0) / 12.0;
+        for (int c = 0; c < 3; ++c) {
+            const double sum = static_cast<double>(sums[c]);
+            const double sxp = static_cast<double>(moments[c]) - cx * sum;
+            const double syp = static_cast<double>(moments[c + 3]) - cy * sum;
+            error -= (sxx > 0.0 ? sxp * sxp / sxx : 0.0) + (syy > 0.0 ? syp * syp / syy : 0.0);
+        }
+    }
+    return std::max(0.0, error);
+}
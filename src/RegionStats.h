@@ -0,0 +1,41 @@
+#ifndef REGIONSTATS_H
+#define REGIONSTATS_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Image.h"
+
+// Tabel jumlah kumulatif (summed-area table) jumlah piksel dan jumlah kuadrat per channel,
+// sehingga warna rata-rata dan jumlah kuadrat error persegi panjang mana pun dapat dihitung
+// dalam O(1). Memakai 48 byte per piksel, ditambah 48 byte jika momen pertama ikut disimpan.
+class RegionStats {
+public:
+    // Indeks 0-2: jumlah R, G, B; indeks 3-5: jumlah kuadrat R, G, B
+    using Sums = std::array<uint64_t, 6>;
+
+    // Indeks 0-2: jumlah x * R, G, B; indeks 3-5: jumlah y * R, G, B (koordinat gambar)
+    using Moments = std::array<uint64_t, 6>;
+
+    // withMoments: simpan juga momen pertama untuk fit bidang warna per blok
+    explicit RegionStats(const Image& image, bool withMoments = false);
+
+    Sums rectSums(int x, int y, int width, int height) const;
+    // Hanya valid jika dibuat dengan withMoments
+    Moments rectMoments(int x, int y, int width, int height) const;
+    bool hasMoments() const { return !momentTable.empty(); }
+    // Byte tabel untuk gambar width x height, tanpa membuatnya
+    static size_t bytesFor(int width, int height, bool withMoments);
+    size_t getMemoryUsage() const;
+    // Jumlah kuadrat selisih terhadap rata-rata (tidak dibulatkan) persegi panjang, semua channel;
+    // jika momen disimpan, terhadap bidang warna least squares persegi panjang tersebut
+    double squaredError(int x, int y, int width, int height) const;
+
+private:
+    int stride; // lebar gambar + 1
+    std::vector<Sums> table;
+    std::vector<Moments> momentTable;
+};
+
+#endif // REGIONSTATS_H
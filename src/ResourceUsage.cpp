@@ -0,0 +1,22 @@
+#include "ResourceUsage.h"
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+size_t ResourceUsage::peakResidentSetKB() {
+#ifdef _WIN32
+    return 0;
+#else
+    rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+#if defined(__APPLE__)
+    // macOS melaporkan ru_maxrss dalam byte, Linux dalam KB
+    return static_cast<size_t>(usage.ru_maxrss) / 1024;
+#else
+    return static_cast<size_t>(usage.ru_maxrss);
+#endif
+#endif
+}
@@ -0,0 +1,12 @@
+#ifndef RESOURCEUSAGE_H
+#define RESOURCEUSAGE_H
+
+#include <cstddef>
+
+class ResourceUsage {
+public:
+    // Puncak resident set size proses sejauh ini dalam KB; 0 jika tidak tersedia
+    static size_t peakResidentSetKB();
+};
+
+#endif // RESOURCEUSAGE_H
@@ -0,0 +1,103 @@
+#include "SizeEstimator.h"
+#include "IOHandler.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <unordered_set>
+#include <vector>
+
+void TreeSizeFeatures::addLeaf(const QuadTreeNode& leaf, const QuadTreeNode* parent, int sign) {
+    const double area = static_cast<double>(leaf.getWidth()) * leaf.getHeight();
+    leaves += sign;
+    rowRuns += sign * leaf.getHeight();
+    perimeter += sign * (leaf.getWidth() + leaf.getHeight());
+    log2AreaSum += sign * std::log2(area);
+    if (area < 64.0) {
+        smallLeafArea += sign * area;
+    }
+    if (parent) {
+        const Pixel a = leaf.getAverageColor();
+        const Pixel b = parent->getAverageColor();
+        const int distance = std::abs(a.r - b.r) + std::abs(a.g - b.g) + std::abs(a.b - b.b);
+        edgeContrast += sign * static_cast<double>(leaf.getWidth() + leaf.getHeight()) * distance;
+    }
+}
+
+TreeSizeFeatures TreeSizeFeatures::fromTree(const Quadtree& tree) {
+    TreeSizeFeatures features;
+    const QuadTreeNode* root = tree.getRoot();
+    if (!root) {
+        return features;
+    }
+    features.width = root->getWidth();
+    features.height = root->getHeight();
+
+    std::unordered_set<uint32_t> colors;
+    std::vector<std::pair<const QuadTreeNode*, const QuadTreeNode*>> stack{{root, nullptr}}; // (simpul, induk)
+    while (!stack.empty()) {
+        const auto [node, parent] = stack.back();
+        stack.pop_back();
+        if (!node->isLeaf()) {
+            for (const auto& child : node->getChildren()) {
+                if (child) {
+                    stack.emplace_back(child.get(), node);
+                }
+            }
+            continue;
+        }
+        const Pixel color = node->getAverageColor();
+        colors.insert((static_cast<uint32_t>(color.r) << 16) | (static_cast<uint32_t>(color.g) << 8) | color.b);
+        features.addLeaf(*node, parent);
+    }
+    features.distinctColors = colors.size();
+    return features;
+}
+
+SizeEstimator::SizeEstimator(const std::string& extension, int jpgQuality)
+    : jpgQuality(std::clamp(jpgQuality, 1, 100)) {
+    format = IOHandler::toLower(extension);
+    if (!format.empty() && format[0] == '.') {
+        format.erase(0, 1);
+    }
+}
+
+double SizeEstimator::rawEstimate(const TreeSizeFeatures& f) const {
+    const double pixels = static_cast<double>(f.width) * f.height;
+
+    if (format == "bmp") {
+        // Tidak terkompresi: header 54 byte + baris 3 byte/piksel yang dibulatkan ke kelipatan 4
+        return 54.0 + static_cast<double>(f.height) * ((3.0 * f.width + 3.0) - std::fmod(3.0 * f.width + 3.0, 4.0));
+    }
+    if (format == "tga") {
+        // RLE per baris: satu paket 4 byte per run. Leaf bertetangga dengan warna sama digabung
+        // encoder, jadi ini hampir selalu batas atas: rapat untuk gambar alami, tetapi beberapa
+        // kali lipat untuk area rata yang terpecah banyak leaf (lihat unit_test)
+        return std::min(18.0 + 4.0 * f.rowRuns, 18.0 + 3.0 * pixels + f.height);
+    }
+    if (format == "jpg" || format == "jpeg") {
+        // Biaya dasar ditambah tepi leaf yang kontras dengan induknya (koefisien AC di blok DCT
+        // yang dilewati tepi) dan leaf lebih kecil dari blok 8x8 yang berisi detail frekuensi
+        // tinggi. Skala kuantisasi mengikuti tabel stb (sama seperti libjpeg); koefisien diukur
+        // pada kualitas 85.
+        auto quantScale = [](int q) { return std::max(1.0, q < 50 ? 5000.0 / q : 200.0 - 2.0 * q); };
+        const double qualityFactor = std::sqrt(quantScale(85) / quantScale(jpgQuality));
+        return (1520.0 + 0.00209 * f.edgeContrast + 0.161 * f.smallLeafArea) * qualityFactor;
+    }
+    // PNG: deflate atas baris berulang (byte per piksel), tepi leaf yang memutus match (tepi
+    // atas/bawah sepanjang lebar leaf lebih mahal daripada potongan baris), leaf besar yang
+    // barisnya berulang murah, warna baru yang tidak bisa diambil dari match sebelumnya, dan
+    // tepi kontras
+    return 30.0 + 0.0238 * pixels - 0.356 * f.rowRuns + 0.493 * f.perimeter - 1.06 * f.log2AreaSum +
+           2.37 * static_cast<double>(f.distinctColors) + 0.00066 * f.edgeContrast;
+}
+
+double SizeEstimator::estimate(const TreeSizeFeatures& features) const {
+    return rawEstimate(features) * scale;
+}
+
+void SizeEstimator::calibrate(const TreeSizeFeatures& features, uintmax_t actualBytes) {
+    const double raw = rawEstimate(features);
+    if (raw > 0.0 && actualBytes > 0) {
+        scale = static_cast<double>(actualBytes) / raw;
+    }
+}
@@ -0,0 +1,52 @@
+#ifndef SIZEESTIMATOR_H
+#define SIZEESTIMATOR_H
+
+#include <string>
+#include <cstddef>
+#include <cstdint>
+#include "QuadTree.h"
+
+// Statistik leaf yang menentukan ukuran hasil encode gambar rekonstruksi
+struct TreeSizeFeatures {
+    int width = 0;
+    int height = 0;
+    size_t leaves = 0;
+    size_t distinctColors = 0;   // keragaman warna; warna berulang lebih murah untuk PNG
+    double rowRuns = 0.0;        // jumlah potongan baris (sum tinggi leaf), sama dengan run RLE per baris
+    double perimeter = 0.0;      // sum (lebar + tinggi) leaf; tepi blok yang memutus match PNG
+    double log2AreaSum = 0.0;    // distribusi ukuran leaf: sum log2(luas); leaf besar berulang murah di PNG
+    double edgeContrast = 0.0;   // sum (lebar + tinggi) * |warna leaf - warna induk| (L1 RGB); tepi yang terlihat
+    double smallLeafArea = 0.0;  // piksel di leaf yang lebih kecil dari blok DCT 8x8 (detail frekuensi tinggi)
+
+    // Kontribusi satu leaf; parent boleh nullptr untuk akar
+    void addLeaf(const QuadTreeNode& leaf, const QuadTreeNode* parent, int sign = 1);
+
+    static TreeSizeFeatures fromTree(const Quadtree& tree);
+};
+
+// Perkiraan ukuran file hasil encode dari statistik pohon, tanpa rekonstruksi maupun encode.
+// Koefisien PNG dan JPG adalah hasil kuadrat terkecil (error relatif) pada gambar test/input
+// dan pola SyntheticImage: `unit_test --input-dir test/input --fit-size-model` mengulang fit,
+// dan unit_test membatasi error perkiraan terhadap encode sebenarnya (sekitar 0.55..1.6x untuk
+// PNG dan JPG). TGA hanya batas atas kasar. Karena itu perkiraan dipakai sebagai titik awal:
+// hasilnya dikoreksi dengan calibrate() setelah ada ukuran encode sebenarnya untuk gambar yang sama.
+class SizeEstimator {
+private:
+    std::string format; // ekstensi huruf kecil tanpa titik
+    int jpgQuality;
+    double scale = 1.0;
+
+    double rawEstimate(const TreeSizeFeatures& features) const;
+
+public:
+    SizeEstimator(const std::string& extension, int jpgQuality);
+
+    double estimate(const TreeSizeFeatures& features) const;
+    double estimate(const Quadtree& tree) const { return estimate(TreeSizeFeatures::fromTree(tree)); }
+
+    // Menyesuaikan skala agar perkiraan untuk features sama dengan actualBytes
+    void calibrate(const TreeSizeFeatures& features, uintmax_t actualBytes);
+    double getScale() const { return scale; }
+};
+
+#endif // SIZEESTIMATOR_H
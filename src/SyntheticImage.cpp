@@ -0,0 +1,125 @@
+#include "SyntheticImage.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+
+// SplitMix64: generator kecil dengan urutan yang sama di semua compiler,
+// berbeda dengan distribusi <random> yang hasilnya bergantung pada implementasi library
+class Rng {
+private:
+    uint64_t state;
+
+public:
+    explicit Rng(uint32_t seed) : state(0x9E3779B97F4A7C15ull ^ seed) {}
+
+    uint32_t next() {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return static_cast<uint32_t>((z ^ (z >> 31)) >> 32);
+    }
+
+    // Bilangan bulat dalam [lo, hi]
+    int range(int lo, int hi) {
+        return lo + static_cast<int>(next() % static_cast<uint32_t>(hi - lo + 1));
+    }
+
+    unsigned char byte() { return static_cast<unsigned char>(next() >> 24); }
+};
+
+void fillRect(Image& img, int x0, int y0, int w, int h, const Pixel& color) {
+    std::vector<Pixel>& pixels = img.getPixelData();
+    const int width = img.getWidth();
+    const int x1 = std::min(width, x0 + w);
+    const int y1 = std::min(img.getHeight(), y0 + h);
+    for (int y = std::max(0, y0); y < y1; ++y) {
+        std::fill(pixels.begin() + static_cast<size_t>(y) * width + std::max(0, x0),
+                  pixels.begin() + static_cast<size_t>(y) * width + x1, color);
+    }
+}
+
+void drawGradient(Image& img) {
+    std::vector<Pixel>& pixels = img.getPixelData();
+    const int w = img.getWidth(), h = img.getHeight();
+    const int wSpan = std::max(1, w - 1), hSpan = std::max(1, h - 1);
+    for (int y = 0; y < h; ++y) {
+        for (int x = 0; x < w; ++x) {
+            pixels[static_cast<size_t>(y) * w + x] = Pixel(
+                static_cast<unsigned char>(x * 255 / wSpan),
+                static_cast<unsigned char>(y * 255 / hSpan),
+                static_cast<unsigned char>((x + y) * 255 / (wSpan + hSpan)));
+        }
+    }
+}
+
+void drawNoise(Image& img, Rng& rng) {
+    for (Pixel& p : img.getPixelData()) {
+        p = Pixel(rng.byte(), rng.byte(), rng.byte());
+    }
+}
+
+void drawFlatRegions(Image& img, Rng& rng) {
+    const int w = img.getWidth(), h = img.getHeight();
+    img.fill(Pixel(rng.byte(), rng.byte(), rng.byte()));
+    for (int i = 0; i < 24; ++i) {
+        int rw = rng.range(std::max(1, w / 16), std::max(1, w / 2));
+        int rh = rng.range(std::max(1, h / 16), std::max(1, h / 2));
+        fillRect(img, rng.range(0, w - 1), rng.range(0, h - 1), rw, rh,
+                 Pixel(rng.byte(), rng.byte(), rng.byte()));
+    }
+}
+
+void drawTextEdges(Image& img, Rng& rng) {
+    const int w = img.getWidth(), h = img.getHeight();
+    img.fill(Pixel(235, 235, 230));
+
+    // Setiap "huruf" adalah grid 3x5 stroke acak, seperti font bitmap kecil
+    const int lineHeight = std::max(6, h / 40);
+    const int stroke = std::max(1, lineHeight / 6);
+    const int glyphWidth = stroke * 3;
+    const int advance = glyphWidth + stroke * 2;
+    const Pixel ink(20, 20, 30);
+
+    for (int top = lineHeight / 2; top + stroke * 5 <= h; top += lineHeight + lineHeight / 2) {
+        for (int left = stroke * 2; left + glyphWidth <= w; left += advance) {
+            if (rng.range(0, 7) == 0) {
+                continue; // spasi antar kata
+            }
+            for (int cell = 0; cell < 15; ++cell) {
+                if (rng.next() & 1u) {
+                    fillRect(img, left + (cell % 3) * stroke, top + (cell / 3) * stroke, stroke, stroke, ink);
+                }
+            }
+        }
+    }
+}
+
+} // namespace
+
+Image SyntheticImage::generate(Pattern pattern, int width, int height, uint32_t seed) {
+    Image img(width, height);
+    Rng rng(seed);
+    switch (pattern) {
+        case Pattern::GRADIENT: drawGradient(img); break;
+        case Pattern::NOISE: drawNoise(img, rng); break;
+        case Pattern::FLAT_REGIONS: drawFlatRegions(img, rng); break;
+        case Pattern::TEXT_EDGES: drawTextEdges(img, rng); break;
+        default: throw std::invalid_argument("Pola gambar sintetis tidak dikenal.");
+    }
+    return img;
+}
+
+std::string SyntheticImage::patternName(Pattern pattern) {
+    switch (pattern) {
+        case Pattern::GRADIENT: return "gradient";
+        case Pattern::NOISE: return "noise";
+        case Pattern::FLAT_REGIONS: return "flat";
+        case Pattern::TEXT_EDGES: return "text";
+    }
+    return "unknown";
+}
+
+std::vector<SyntheticImage::Pattern> SyntheticImage::allPatterns() {
+    return {Pattern::GRADIENT, Pattern::NOISE, Pattern::FLAT_REGIONS, Pattern::TEXT_EDGES};
+}
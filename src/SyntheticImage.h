@@ -0,0 +1,26 @@
+#ifndef SYNTHETICIMAGE_H
+#define SYNTHETICIMAGE_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "Image.h"
+
+// Gambar uji buatan yang deterministik (hasil sama di semua platform untuk seed yang sama),
+// dipakai oleh benchmark dan golden test sehingga tidak bergantung pada file gambar.
+class SyntheticImage {
+public:
+    enum class Pattern {
+        GRADIENT,     // gradasi halus dua arah
+        NOISE,        // noise acak per piksel (kasus terburuk, pohon sangat dalam)
+        FLAT_REGIONS, // persegi berwarna rata yang saling menumpuk (kasus terbaik)
+        TEXT_EDGES    // garis tipis kontras tinggi di atas latar terang, mirip teks
+    };
+
+    static Image generate(Pattern pattern, int width, int height, uint32_t seed = 1);
+
+    static std::string patternName(Pattern pattern);
+    static std::vector<Pattern> allPatterns();
+};
+
+#endif // SYNTHETICIMAGE_H
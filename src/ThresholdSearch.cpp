@@ -0,0 +1,161 @@
+#include "ThresholdSearch.h"
+#include <algorithm>
+#include <cmath>
+
+ThresholdSearch::ThresholdSearch(double low, double high, double targetBytes, double toleranceBytes)
+    : low(low), high(std::max(low, high)), targetBytes(std::max(1.0, targetBytes)),
+      toleranceBytes(std::max(0.0, toleranceBytes)), minWidth((this->high - low) * 1e-6) {}
+
+// Threshold 0 tidak punya logaritma; batas bawah efektifnya sepersejuta rentang
+double ThresholdSearch::logThreshold(double threshold) const {
+    const double floor = std::max(low, high * 1e-6);
+    return std::log(std::max(threshold, floor > 0.0 ? floor : 1e-12));
+}
+
+double ThresholdSearch::fromLogThreshold(double value) const {
+    return std::clamp(std::exp(value), low, high);
+}
+
+const ThresholdSearch::Sample* ThresholdSearch::upperBracket() const {
+    for (const Sample& s : samples) {
+        if (s.bytes <= targetBytes) {
+            return &s;
+        }
+    }
+    return nullptr;
+}
+
+const ThresholdSearch::Sample* ThresholdSearch::lowerBracket() const {
+    const Sample* upper = upperBracket();
+    const Sample* lower = nullptr;
+    for (const Sample& s : samples) {
+        if (upper && s.threshold >= upper->threshold) {
+            break;
+        }
+        if (s.bytes > targetBytes) {
+            lower = &s;
+        }
+    }
+    return lower;
+}
+
+double ThresholdSearch::next() {
+    const Sample* lower = lowerBracket();
+    const Sample* upper = upperBracket();
+    const double x0 = logThreshold(lower ? lower->threshold : low);
+    const double x1 = logThreshold(upper ? upper->threshold : high);
+
+    // Target baru terlihat di satu sisi: ujung rentang dicoba sekali, sehingga target yang
+    // tidak tercapai langsung terdeteksi dan secant punya bracket untuk interpolasi
+    if (!lower && upper && !lookup(low)) {
+        return low;
+    }
+    if (!upper && lower && !lookup(high)) {
+        return high;
+    }
+    // Belum ada sampel, atau secant berulang kali hanya menggeser satu sisi
+    if (!lower || !upper || staleCount >= 3) {
+        return fromLogThreshold((x0 + x1) / 2.0);
+    }
+
+    // Modifikasi Illinois: nilai sisi yang tertahan dua kali berturut-turut dibagi dua
+    const double staleWeight = staleCount >= 2 ? std::pow(0.5, staleCount - 1) : 1.0;
+    double y0 = std::log(lower->bytes / targetBytes);
+    double y1 = std::log(std::max(upper->bytes, 1.0) / targetBytes);
+    if (staleSide < 0) {
+        y0 *= staleWeight;
+    } else if (staleSide > 0) {
+        y1 *= staleWeight;
+    }
+    double x = (y0 == y1) ? (x0 + x1) / 2.0 : x0 - y0 * (x1 - x0) / (y1 - y0);
+    // Titik yang terlalu dekat ke ujung bracket hampir tidak mempersempit rentang
+    const double margin = 0.05 * (x1 - x0);
+    x = std::clamp(x, x0 + margin, x1 - margin);
+    return fromLogThreshold(x);
+}
+
+std::vector<double> ThresholdSearch::nextBatch(size_t count) {
+    std::vector<double> points;
+    if (count <= 1) {
+        points.push_back(next());
+    } else {
+        const Sample* lower = lowerBracket();
+        const Sample* upper = upperBracket();
+        if ((!lower && upper && !lookup(low)) || (!upper && lower && !lookup(high)) || (lower && upper && staleCount < 3)) {
+            points.push_back(next()); // ujung rentang atau titik secant
+        }
+        const double x0 = logThreshold(lower ? lower->threshold : low);
+        const double x1 = logThreshold(upper ? upper->threshold : high);
+        const size_t even = count - points.size();
+        for (size_t i = 1; i <= even; ++i) {
+            points.push_back(fromLogThreshold(x0 + (x1 - x0) * static_cast<double>(i) / static_cast<double>(even + 1)));
+        }
+    }
+
+    std::sort(points.begin(), points.end());
+    points.erase(std::unique(points.begin(), points.end()), points.end());
+    points.erase(std::remove_if(points.begin(), points.end(), [this](double t) { return lookup(t).has_value(); }),
+                 points.end());
+    return points;
+}
+
+void ThresholdSearch::record(const Sample& sample) {
+    const Sample* oldLower = lowerBracket();
+    const Sample* oldUpper = upperBracket();
+    const double oldLowerTh = oldLower ? oldLower->threshold : low;
+    const double oldUpperTh = oldUpper ? oldUpper->threshold : high;
+
+    auto it = std::lower_bound(samples.begin(), samples.end(), sample.threshold,
+                               [](const Sample& s, double threshold) { return s.threshold < threshold; });
+    if (it != samples.end() && it->threshold == sample.threshold) {
+        *it = sample;
+    } else {
+        samples.insert(it, sample);
+    }
+
+    const Sample* newLower = lowerBracket();
+    const Sample* newUpper = upperBracket();
+    const bool lowerMoved = (newLower ? newLower->threshold : low) != oldLowerTh;
+    const bool upperMoved = (newUpper ? newUpper->threshold : high) != oldUpperTh;
+    // Sisi yang tidak bergerak dicatat untuk modifikasi Illinois
+    const int retained = lowerMoved && !upperMoved ? 1 : (upperMoved && !lowerMoved ? -1 : 0);
+    if (retained != 0 && retained == staleSide) {
+        ++staleCount;
+    } else {
+        staleSide = retained;
+        staleCount = retained != 0 ? 1 : 0;
+    }
+}
+
+std::optional<ThresholdSearch::Sample> ThresholdSearch::lookup(double threshold) const {
+    for (const Sample& s : samples) {
+        if (s.threshold == threshold) {
+            return s;
+        }
+    }
+    return std::nullopt;
+}
+
+bool ThresholdSearch::converged() const {
+    for (const Sample& s : samples) {
+        if (std::abs(s.bytes - targetBytes) <= toleranceBytes) {
+            return true;
+        }
+    }
+    const Sample* lower = lowerBracket();
+    const Sample* upper = upperBracket();
+    const double lowTh = lower ? lower->threshold : low;
+    const double highTh = upper ? upper->threshold : high;
+    return (highTh - lowTh) <= minWidth || (logThreshold(highTh) - logThreshold(lowTh)) <= 1e-4;
+}
+
+std::optional<ThresholdSearch::Sample> ThresholdSearch::best() const {
+    std::optional<Sample> result;
+    for (const Sample& s : samples) {
+        // Seri dimenangkan threshold yang lebih besar (pohon lebih kecil)
+        if (!result || std::abs(s.bytes - targetBytes) <= std::abs(result->bytes - targetBytes)) {
+            result = s;
+        }
+    }
+    return result;
+}
@@ -0,0 +1,57 @@
+#ifndef THRESHOLDSEARCH_H
+#define THRESHOLDSEARCH_H
+
+#include <cstddef>
+#include <optional>
+#include <vector>
+
+// Pencarian threshold yang ukuran hasilnya mendekati target. Ukuran turun monoton saat
+// threshold naik, sehingga setelah target terapit oleh dua sampel, langkah berikutnya
+// diinterpolasi (secant pada log threshold vs log ukuran, dengan modifikasi Illinois).
+// Bisection di ruang log threshold hanya dipakai selama target belum terapit atau saat
+// interpolasi tidak mempersempit rentang.
+class ThresholdSearch {
+public:
+    struct Sample {
+        double threshold;
+        size_t nodes;
+        double bytes;
+    };
+
+    // [low, high] = rentang threshold metrik; toleranceBytes = selisih yang dianggap tepat
+    ThresholdSearch(double low, double high, double targetBytes, double toleranceBytes);
+
+    // Threshold yang sebaiknya dicoba berikutnya
+    double next();
+    // count threshold untuk dicoba bersamaan: titik secant (jika ada) ditambah titik yang
+    // membagi bracket secara merata di ruang log, sehingga bracket menyusut sekitar
+    // (count + 1) kali per putaran. Terurut dan tanpa threshold yang sudah dicoba.
+    std::vector<double> nextBatch(size_t count);
+    // Menyimpan hasil percobaan; sampel dengan threshold yang sama diganti
+    void record(const Sample& sample);
+    // Sampel tersimpan untuk threshold ini, jika sudah pernah dicoba
+    std::optional<Sample> lookup(double threshold) const;
+
+    // Target tercapai dalam toleransi, atau rentang tidak dapat dipersempit lagi
+    bool converged() const;
+    // Sampel dengan selisih ukuran terkecil terhadap target
+    std::optional<Sample> best() const;
+    const std::vector<Sample>& getSamples() const { return samples; }
+
+private:
+    double low;
+    double high;
+    double targetBytes;
+    double toleranceBytes;
+    double minWidth;           // lebar rentang minimum sebelum dianggap konvergen
+    std::vector<Sample> samples; // terurut menurut threshold
+    int staleSide = 0;         // sisi bracket yang tidak bergerak pada langkah terakhir (-1 bawah, +1 atas)
+    int staleCount = 0;
+
+    double logThreshold(double threshold) const;
+    double fromLogThreshold(double value) const;
+    const Sample* lowerBracket() const; // threshold terbesar dengan ukuran > target
+    const Sample* upperBracket() const; // threshold terkecil dengan ukuran <= target
+};
+
+#endif // THRESHOLDSEARCH_H
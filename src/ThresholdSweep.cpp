@@ -0,0 +1,213 @@
+#include "ThresholdSweep.h"
+#include "Trace.h"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <unordered_map>
+
+namespace {
+
+// Threshold negatif = pohon penuh tanpa menghitung error saat build; penggabungan leaf
+// akan merusak titik patah, jadi dimatikan
+QuadtreeOptions depthFirst(QuadtreeOptions options) {
+    options.buildMode = BuildMode::DEPTH_FIRST;
+    options.mergeTolerance = -1;
+    return options;
+}
+
+uint32_t packColor(const Pixel& p) {
+    return (static_cast<uint32_t>(p.r) << 16) | (static_cast<uint32_t>(p.g) << 8) | p.b;
+}
+
+} // namespace
+
+ThresholdSweep::ThresholdSweep(const Image& image, ErrorMetric metric, int minBlockSize, QuadtreeOptions options)
+    : sourceImage(image), fullTree(image, metric, -1.0, minBlockSize, depthFirst(options)) {
+    Trace::Scope trace("sweep", "sweep");
+    collectRecords();
+    computePoints();
+    trace.arg("points", static_cast<double>(points.size()));
+}
+
+void ThresholdSweep::collectRecords() {
+    records.reserve(fullTree.getNodeCount());
+    std::vector<std::pair<int, double>> stack; // (indeks induk, splitThreshold induk)
+    std::vector<const QuadTreeNode*> nodeStack{fullTree.getRoot()};
+    stack.emplace_back(-1, std::numeric_limits<double>::infinity());
+    while (!nodeStack.empty()) {
+        const QuadTreeNode* node = nodeStack.back();
+        nodeStack.pop_back();
+        auto [parent, parentSplit] = stack.back();
+        stack.pop_back();
+
+        NodeRecord record{node, parent < 0 ? nullptr : records[parent].node,
+                          parent < 0 ? 1 : records[parent].depth + 1, -1.0, {}};
+        if (!node->isLeaf()) {
+            record.splitThreshold = std::min(fullTree.nodeError(*node), parentSplit);
+        }
+        const int index = static_cast<int>(records.size());
+        records.push_back(std::move(record));
+        if (parent >= 0) {
+            records[parent].children.push_back(index);
+        }
+        for (const auto& child : node->children) {
+            if (child) {
+                nodeStack.push_back(child.get());
+                stack.emplace_back(index, records[index].splitThreshold);
+            }
+        }
+    }
+}
+
+void ThresholdSweep::computePoints() {
+    // Split diterapkan dari threshold terbesar; pada nilai sama, induk lebih dulu dari anaknya
+    std::vector<int> order;
+    for (size_t i = 0; i < records.size(); ++i) {
+        if (records[i].splitThreshold > 0.0) {
+            order.push_back(static_cast<int>(i));
+        }
+    }
+    std::sort(order.begin(), order.end(), [this](int a, int b) {
+        if (records[a].splitThreshold != records[b].splitThreshold) {
+            return records[a].splitThreshold > records[b].splitThreshold;
+        }
+        return records[a].depth < records[b].depth;
+    });
+
+    const size_t pixelCount = static_cast<size_t>(sourceImage.getWidth()) * sourceImage.getHeight();
+    SweepPoint current;
+    current.features.width = sourceImage.getWidth();
+    current.features.height = sourceImage.getHeight();
+    std::unordered_map<uint32_t, size_t> colorCounts;
+    double sse = 0.0;
+    double ssimArea = 0.0;
+
+    auto addLeaf = [&](const NodeRecord& r, int sign) {
+        const double area = static_cast<double>(r.node->width) * r.node->height;
+        current.leaves += sign;
+        current.features.addLeaf(*r.node, r.parent, sign);
+        sse += sign * r.node->getSquaredError();
+        ssimArea += sign * r.node->getSSIM() * area;
+        const uint32_t color = packColor(r.node->averageColor);
+        if (sign > 0) {
+            ++colorCounts[color];
+        } else if (--colorCounts[color] == 0) {
+            colorCounts.erase(color);
+        }
+    };
+    auto emit = [&](double low, double high) {
+        current.thresholdLow = low;
+        current.thresholdHigh = high;
+        current.features.leaves = current.leaves;
+        current.features.distinctColors = colorCounts.size();
+        current.psnr = Quadtree::psnrFromSquaredError(sse, pixelCount);
+        current.ssim = ssimArea / static_cast<double>(pixelCount);
+        points.push_back(current);
+    };
+
+    current.nodes = 1;
+    current.depth = 1;
+    addLeaf(records[0], 1);
+    double high = std::numeric_limits<double>::infinity();
+    for (size_t k = 0; k < order.size();) {
+        const double split = records[order[k]].splitThreshold;
+        emit(split, high);
+        for (; k < order.size() && records[order[k]].splitThreshold == split; ++k) {
+            const NodeRecord& r = records[order[k]];
+            addLeaf(r, -1);
+            for (int child : r.children) {
+                addLeaf(records[child], 1);
+            }
+            current.nodes += r.children.size();
+            current.depth = std::max(current.depth, r.depth + 1);
+        }
+        high = split;
+    }
+    emit(0.0, high);
+}
+
+void ThresholdSweep::measureSizes(const std::string& extension, int jpgQuality, size_t encodeCount) {
+    SizeEstimator estimator(extension, jpgQuality);
+    std::vector<double> raw(points.size());
+    for (size_t i = 0; i < points.size(); ++i) {
+        raw[i] = estimator.estimate(points[i].features);
+        points[i].estimatedBytes = raw[i];
+    }
+    if (encodeCount == 0 || points.empty()) {
+        return;
+    }
+
+    // Titik yang di-encode tersebar merata menurut indeks (termasuk ujung-ujungnya)
+    encodeCount = std::min(encodeCount, points.size());
+    std::vector<size_t> encoded;
+    for (size_t k = 0; k < encodeCount; ++k) {
+        const size_t index = encodeCount == 1 ? points.size() / 2 : k * (points.size() - 1) / (encodeCount - 1);
+        if (encoded.empty() || encoded.back() != index) {
+            encoded.push_back(index);
+        }
+    }
+    for (size_t index : encoded) {
+        Trace::Scope trace("sweep", "encode point");
+        trace.arg("threshold", points[index].thresholdLow);
+        points[index].encodedBytes = static_cast<long long>(
+            reconstructImage(points[index].thresholdLow).encodeToMemory(extension, jpgQuality).size());
+    }
+
+    // Setiap titik memakai rasio encode/perkiraan dari titik ter-encode terdekat (menurut indeks)
+    size_t nearest = 0;
+    for (size_t i = 0; i < points.size(); ++i) {
+        while (nearest + 1 < encoded.size() && encoded[nearest + 1] <= i) {
+            ++nearest;
+        }
+        if (nearest + 1 < encoded.size() && encoded[nearest] < i && encoded[nearest + 1] - i < i - encoded[nearest]) {
+            ++nearest;
+        }
+        const size_t anchor = encoded[nearest];
+        if (raw[anchor] > 0.0) {
+            points[i].estimatedBytes = raw[i] * static_cast<double>(points[anchor].encodedBytes) / raw[anchor];
+        }
+    }
+}
+
+const SweepPoint* ThresholdSweep::coarsestMeeting(double minPsnr, double minSsim) const {
+    for (const SweepPoint& point : points) {
+        if (point.psnr >= minPsnr && point.ssim >= minSsim) {
+            return &point;
+        }
+    }
+    return nullptr;
+}
+
+Image ThresholdSweep::reconstructImage(double threshold) const {
+    Image reconstructed(sourceImage.getWidth(), sourceImage.getHeight());
+    std::vector<int> stack{0};
+    while (!stack.empty()) {
+        const NodeRecord& r = records[stack.back()];
+        stack.pop_back();
+        if (r.splitThreshold > threshold) {
+            stack.insert(stack.end(), r.children.begin(), r.children.end());
+            continue;
+        }
+        r.node->paint(reconstructed);
+    }
+    return reconstructed;
+}
+
+void ThresholdSweep::writeCsv(std::ostream& out) const {
+    out << "threshold_low,threshold_high,nodes,leaves,depth,psnr,ssim,estimated_bytes,encoded_bytes\n";
+    out << std::setprecision(10);
+    for (const SweepPoint& p : points) {
+        out << p.thresholdLow << ",";
+        if (std::isinf(p.thresholdHigh)) {
+            out << "inf";
+        } else {
+            out << p.thresholdHigh;
+        }
+        out << "," << p.nodes << "," << p.leaves << "," << p.depth << "," << p.psnr << "," << p.ssim << ","
+            << static_cast<long long>(std::llround(p.estimatedBytes)) << ",";
+        if (p.encodedBytes >= 0) {
+            out << p.encodedBytes;
+        }
+        out << "\n";
+    }
+}
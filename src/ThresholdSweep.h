@@ -0,0 +1,71 @@
+#ifndef THRESHOLDSWEEP_H
+#define THRESHOLDSWEEP_H
+
+#include <limits>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "Image.h"
+#include "QuadTree.h"
+#include "SizeEstimator.h"
+
+// Satu pohon berbeda pada kurva threshold. Pohon DEPTH_FIRST untuk threshold mana pun di
+// [thresholdLow, thresholdHigh) sama persis dengan pohon pada titik ini.
+struct SweepPoint {
+    double thresholdLow = 0.0;
+    double thresholdHigh = std::numeric_limits<double>::infinity();
+    size_t nodes = 0;
+    size_t leaves = 0;
+    int depth = 0;
+    double psnr = 0.0;
+    double ssim = 0.0;            // SSIM tiap leaf dirata-rata berbobot luas (Quadtree::getSSIM)
+    TreeSizeFeatures features;
+    double estimatedBytes = 0.0;
+    long long encodedBytes = -1;  // -1 = titik ini tidak di-encode
+};
+
+// Kurva rate/kualitas lengkap dari satu pohon penuh. Error setiap simpul dihitung sekali
+// (SSE dan SSIM blok sudah tersimpan di simpul sejak pembentukan);
+// simpul ter-split pada threshold t jika error simpul itu dan semua leluhurnya > t, sehingga
+// semua titik patah (threshold tempat pohon benar-benar berubah) didapat dengan mengurutkan
+// min(error, error leluhur) dan menambahkan split satu per satu secara inkremental.
+class ThresholdSweep {
+private:
+    struct NodeRecord {
+        const QuadTreeNode* node;
+        const QuadTreeNode* parent; // nullptr untuk akar
+        int depth;
+        double splitThreshold; // pohon di-split di simpul ini untuk threshold < nilai ini; -1 jika leaf penuh
+        std::vector<int> children;
+    };
+
+    const Image& sourceImage;
+    Quadtree fullTree;
+    std::vector<NodeRecord> records;
+    std::vector<SweepPoint> points;
+
+    void collectRecords();
+    void computePoints();
+
+public:
+    ThresholdSweep(const Image& image, ErrorMetric metric, int minBlockSize, QuadtreeOptions options = {});
+
+    // Mengisi estimatedBytes semua titik. Jika encodeCount > 0, sebanyak itu titik yang
+    // tersebar merata di-encode sungguhan, dan perkiraan titik lain dikalibrasi dengan
+    // hasil encode terdekat.
+    void measureSizes(const std::string& extension, int jpgQuality, size_t encodeCount);
+
+    // Titik pertama (threshold terbesar, pohon terkecil) yang memenuhi kedua batas kualitas;
+    // nullptr jika pohon penuh pun tidak memenuhi
+    const SweepPoint* coarsestMeeting(double minPsnr, double minSsim) const;
+
+    // Rekonstruksi pohon untuk threshold tertentu tanpa membangun ulang
+    Image reconstructImage(double threshold) const;
+
+    const std::vector<SweepPoint>& getPoints() const { return points; }
+    const Quadtree& getFullTree() const { return fullTree; }
+
+    void writeCsv(std::ostream& out) const;
+};
+
+#endif // THRESHOLDSWEEP_H
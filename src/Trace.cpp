@@ -0,0 +1,179 @@
+#include "Trace.h"
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Event {
+    const char* category;
+    std::string name;
+    std::string args;
+    int tid;
+    double startUs;
+    double durationUs;
+};
+
+struct TraceState {
+    std::atomic<bool> enabled{false};
+    std::mutex mutex;
+    std::string path;
+    Clock::time_point origin;
+    std::vector<Event> events;
+    std::map<int, std::string> threadNames;
+};
+
+TraceState& state() {
+    static TraceState instance;
+    return instance;
+}
+
+// Nomor thread kecil dan stabil untuk field "tid"
+int currentTid() {
+    static std::atomic<int> nextTid{1};
+    thread_local int tid = nextTid++;
+    return tid;
+}
+
+std::string escapeJson(const std::string& text) {
+    std::ostringstream out;
+    for (unsigned char c : text) {
+        switch (c) {
+            case '"': out << "\\\""; break;
+            case '\\': out << "\\\\"; break;
+            case '\n': out << "\\n"; break;
+            case '\t': out << "\\t"; break;
+            default:
+                if (c < 0x20) {
+                    out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c)
+                        << std::dec << std::setfill(' ');
+                } else {
+                    out << c;
+                }
+        }
+    }
+    return out.str();
+}
+
+double microsecondsSince(Clock::time_point origin, Clock::time_point t) {
+    return std::chrono::duration<double, std::micro>(t - origin).count();
+}
+
+} // namespace
+
+void Trace::start(const std::string& path) {
+    TraceState& s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    s.path = path;
+    s.origin = Clock::now();
+    s.events.clear();
+    s.threadNames.clear();
+    s.enabled.store(true, std::memory_order_release);
+}
+
+bool Trace::enabled() {
+    return state().enabled.load(std::memory_order_acquire);
+}
+
+void Trace::nameThread(const std::string& name) {
+    if (!enabled()) {
+        return;
+    }
+    TraceState& s = state();
+    const int tid = currentTid();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    s.threadNames[tid] = name;
+}
+
+bool Trace::stop() {
+    TraceState& s = state();
+    if (!s.enabled.exchange(false)) {
+        return true;
+    }
+    std::lock_guard<std::mutex> lock(s.mutex);
+
+    std::ofstream out(s.path);
+    if (!out) {
+        return false;
+    }
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool first = true;
+    for (const auto& [tid, name] : s.threadNames) {
+        out << (first ? "" : ",\n") << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" << tid
+            << ",\"args\":{\"name\":\"" << escapeJson(name) << "\"}}";
+        first = false;
+    }
+    out << std::fixed << std::setprecision(3);
+    for (const Event& e : s.events) {
+        out << (first ? "" : ",\n") << "{\"ph\":\"X\",\"cat\":\"" << e.category << "\",\"name\":\""
+            << escapeJson(e.name) << "\",\"pid\":1,\"tid\":" << e.tid << ",\"ts\":" << e.startUs
+            << ",\"dur\":" << e.durationUs;
+        if (!e.args.empty()) {
+            out << ",\"args\":{" << e.args << "}";
+        }
+        out << "}";
+        first = false;
+    }
+    out << "\n]}\n";
+    s.events.clear();
+    return static_cast<bool>(out);
+}
+
+Trace::Scope::Scope(const char* category, std::string name)
+    : active(Trace::enabled()), category(category) {
+    if (active) {
+        this->name = std::move(name);
+        start = Clock::now();
+    }
+}
+
+Trace::Scope::~Scope() {
+    if (!active) {
+        return;
+    }
+    const Clock::time_point end = Clock::now();
+    TraceState& s = state();
+    const int tid = currentTid();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    if (!s.enabled.load(std::memory_order_relaxed)) {
+        return; // trace sudah ditutup selagi scope ini berjalan
+    }
+    s.events.push_back(Event{category, std::move(name), std::move(args), tid,
+                             microsecondsSince(s.origin, start), microsecondsSince(start, end)});
+}
+
+void Trace::Scope::arg(const char* key, double value) {
+    if (!active) {
+        return;
+    }
+    std::ostringstream out;
+    out << (args.empty() ? "" : ",") << "\"" << key << "\":" << value;
+    args += out.str();
+}
+
+void Trace::Scope::arg(const char* key, const std::string& value) {
+    if (!active) {
+        return;
+    }
+    args += (args.empty() ? "\"" : ",\"") + std::string(key) + "\":\"" + escapeJson(value) + "\"";
+}
+
+TraceSession::TraceSession(const std::string& path) : active(!path.empty()) {
+    if (active) {
+        Trace::start(path);
+        Trace::nameThread("main");
+    }
+}
+
+TraceSession::~TraceSession() {
+    if (active && !Trace::stop()) {
+        std::cerr << "[ERROR] Gagal menulis file trace." << std::endl;
+    }
+}
@@ -0,0 +1,59 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <chrono>
+#include <string>
+
+// Perekam timeline dalam format Chrome trace JSON (dapat dibuka di chrome://tracing atau
+// ui.perfetto.dev). Berbeda dengan Instrumentation yang hanya aktif saat kompilasi, trace
+// diaktifkan saat runtime (--trace <file>); jika tidak aktif, setiap Scope hanya memeriksa
+// satu flag atomik.
+class Trace {
+public:
+    // Mulai merekam; event dikumpulkan di memori sampai stop() dipanggil
+    static void start(const std::string& path);
+
+    // Menulis semua event ke file yang diberikan pada start(); false jika penulisan gagal
+    static bool stop();
+
+    static bool enabled();
+
+    // Nama thread pemanggil yang ditampilkan di timeline (misalnya "main", "pool worker")
+    static void nameThread(const std::string& name);
+
+    // Event lengkap (begin/end) selama umur objek di thread pemanggil
+    class Scope {
+    private:
+        bool active;
+        const char* category;
+        std::string name;
+        std::string args; // potongan JSON "key":value yang sudah diformat
+        std::chrono::steady_clock::time_point start;
+
+    public:
+        Scope(const char* category, std::string name);
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+        void arg(const char* key, double value);
+        void arg(const char* key, const std::string& value);
+    };
+};
+
+// Merekam trace selama umur objek jika path tidak kosong, sehingga file tetap ditulis
+// walaupun kompresi berakhir dengan exception
+class TraceSession {
+private:
+    bool active;
+
+public:
+    explicit TraceSession(const std::string& path);
+    ~TraceSession();
+
+    TraceSession(const TraceSession&) = delete;
+    TraceSession& operator=(const TraceSession&) = delete;
+};
+
+#endif // TRACE_H
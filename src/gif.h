@@ -25,6 +25,9 @@
 // Pass subsequent frames to GifWriteFrame().
 // Finally, call GifEnd() to close the file handle and free memory.
 //
+// To write somewhere other than a file (a memory buffer, a socket, ...) use GifBeginSink()
+// with one of the GifXxxSinkWrite functions or your own callback.
+//
 
 #ifndef gif_h
 #define gif_h
@@ -34,11 +37,18 @@
 #include <stdint.h>  // for integer typedefs
 #include <stdbool.h> // for bool macros
 
+#if defined(_WIN32)
+#include <io.h>      // for _write
+#else
+#include <unistd.h>  // for write
+#include <errno.h>
+#endif
+
 // Define these macros to hook into a custom memory allocator.
 // TEMP_MALLOC and TEMP_FREE will only be called in stack fashion - frees in the reverse order of mallocs
 // and any temp memory allocated by a function will be freed before it exits.
-// MALLOC and FREE are used only by GifBegin and GifEnd respectively (to allocate a buffer the size of the image, which
-// is used to find changed pixels for delta-encoding.)
+// MALLOC and FREE are used by GifBegin and GifEnd respectively (to allocate a buffer the size of the image, which
+// is used to find changed pixels for delta-encoding, and the LZW dictionary shared by all frames), and by GifBuffer.
 
 #ifndef GIF_TEMP_MALLOC
 #include <stdlib.h>
@@ -82,10 +92,63 @@ int GifIMax(int l, int r) { return l>r?l:r; }
 int GifIMin(int l, int r) { return l<r?l:r; }
 int GifIAbs(int i) { return i<0?-i:i; }
 
+// Growable byte buffer. Encoded frames are assembled in here first so that
+// several frames can be encoded at once and appended to the file in order.
+typedef struct
+{
+    uint8_t* data;
+    size_t size;
+    size_t capacity;
+} GifBuffer;
+
+void GifBufferInit( GifBuffer* buf )
+{
+    buf->data = NULL;
+    buf->size = 0;
+    buf->capacity = 0;
+}
+
+void GifBufferFree( GifBuffer* buf )
+{
+    GIF_FREE(buf->data);
+    GifBufferInit(buf);
+}
+
+void GifBufferReserve( GifBuffer* buf, size_t extra )
+{
+    if( buf->size + extra <= buf->capacity )
+        return;
+
+    size_t newCapacity = buf->capacity? buf->capacity : 4096;
+    while( newCapacity < buf->size + extra )
+        newCapacity *= 2;
+
+    uint8_t* newData = (uint8_t*)GIF_MALLOC(newCapacity);
+    if( buf->size )
+        memcpy(newData, buf->data, buf->size);
+    GIF_FREE(buf->data);
+
+    buf->data = newData;
+    buf->capacity = newCapacity;
+}
+
+void GifBufferPut( GifBuffer* buf, uint8_t byte )
+{
+    GifBufferReserve(buf, 1);
+    buf->data[buf->size++] = byte;
+}
+
+void GifBufferWrite( GifBuffer* buf, const void* data, size_t size )
+{
+    GifBufferReserve(buf, size);
+    memcpy(buf->data + buf->size, data, size);
+    buf->size += size;
+}
+
 // walks the k-d tree to pick the palette entry for a desired color.
 // Takes as in/out parameters the current best color and its error -
 // only changes them if it finds a better color in its subtree.
-// this is the major hotspot in the code at the moment.
+// Per-pixel callers should go through GifLookupPaletteColor, which caches the result.
 void GifGetClosestPaletteColor( GifPalette* pPal, int r, int g, int b, int* bestInd, int* bestDiff, int treeRoot )
 {
     // base case, reached the bottom of the tree
@@ -134,6 +197,66 @@ void GifGetClosestPaletteColor( GifPalette* pPal, int r, int g, int b, int* best
     }
 }
 
+// Memoizes GifGetClosestPaletteColor for one palette. Slots are picked by hashing
+// the full 24-bit color and each slot remembers the color it holds, so a lookup
+// either returns exactly what the tree search would or falls back to the search.
+// Quadtree frames are made of large flat blocks, so almost every pixel is a hit.
+// The top byte of each key is the palette generation, so switching to a new palette
+// only bumps the generation; the table itself is cleared once every 255 palettes.
+// A cache is meant to be reused across frames (one per encoding thread).
+#define GIF_PALETTE_CACHE_BITS 15
+
+typedef struct
+{
+    uint32_t key[1 << GIF_PALETTE_CACHE_BITS];  // generation << 24 | 0xRRGGBB of the cached color
+    uint8_t index[1 << GIF_PALETTE_CACHE_BITS];
+    uint32_t generation;                        // 1..255 while in use, 0 marks an empty slot
+} GifPaletteCache;
+
+void GifPaletteCacheInit( GifPaletteCache* cache )
+{
+    memset(cache->key, 0, sizeof(cache->key));
+    cache->generation = 0;
+}
+
+// must be called whenever the palette changes
+void GifPaletteCacheReset( GifPaletteCache* cache )
+{
+    if( ++cache->generation > 255 )
+    {
+        memset(cache->key, 0, sizeof(cache->key));
+        cache->generation = 1;
+    }
+}
+
+int GifLookupPaletteColor( GifPalette* pPal, GifPaletteCache* cache, int r, int g, int b )
+{
+    // dithering can push the requested color outside 0..255, those don't fit a key
+    if( (uint32_t)(r | g | b) > 255 )
+    {
+        int32_t bestDiff = 1000000;
+        int32_t bestInd = kGifTransIndex;
+        GifGetClosestPaletteColor(pPal, r, g, b, &bestInd, &bestDiff, 1);
+        return bestInd;
+    }
+
+    uint32_t color = ((uint32_t)r << 16) | ((uint32_t)g << 8) | (uint32_t)b;
+    uint32_t slot = (color * 2654435761u) >> (32 - GIF_PALETTE_CACHE_BITS);
+    uint32_t key = (cache->generation << 24) | color;
+
+    if( cache->key[slot] != key )
+    {
+        int32_t bestDiff = 1000000;
+        int32_t bestInd = kGifTransIndex;
+        GifGetClosestPaletteColor(pPal, r, g, b, &bestInd, &bestDiff, 1);
+
+        cache->key[slot] = key;
+        cache->index[slot] = (uint8_t)bestInd;
+    }
+
+    return cache->index[slot];
+}
+
 void GifSwapPixels(uint8_t* image, int pixA, int pixB)
 {
     uint8_t rA = image[pixA*4];
@@ -380,6 +503,9 @@ int GifPickChangedPixels( const uint8_t* lastFrame, uint8_t* frame, int numPixel
 // This is known as the "median split" technique
 void GifMakePalette( const uint8_t* lastFrame, const uint8_t* nextFrame, uint32_t width, uint32_t height, int bitDepth, bool buildForDither, GifPalette* pPal )
 {
+    // entries for empty subtrees are never visited by GifSplitPalette - clear them so
+    // the output doesn't depend on whatever happened to be on the stack
+    memset(pPal, 0, sizeof(GifPalette));
     pPal->bitDepth = bitDepth;
 
     // SplitPalette is destructive (it sorts the pixels by color) so
@@ -403,8 +529,9 @@ void GifMakePalette( const uint8_t* lastFrame, const uint8_t* nextFrame, uint32_
     pPal->r[0] = pPal->g[0] = pPal->b[0] = 0;
 }
 
-// Implements Floyd-Steinberg dithering, writes palette value to alpha
-void GifDitherImage( const uint8_t* lastFrame, const uint8_t* nextFrame, uint8_t* outFrame, uint32_t width, uint32_t height, GifPalette* pPal )
+// Implements Floyd-Steinberg dithering, writes palette value to alpha.
+// cache may be NULL to use a temporary one.
+void GifDitherImage( const uint8_t* lastFrame, const uint8_t* nextFrame, uint8_t* outFrame, uint32_t width, uint32_t height, GifPalette* pPal, GifPaletteCache* cache )
 {
     int numPixels = (int)(width * height);
 
@@ -413,6 +540,15 @@ void GifDitherImage( const uint8_t* lastFrame, const uint8_t* nextFrame, uint8_t
     // to be propagated
     int32_t *quantPixels = (int32_t *)GIF_TEMP_MALLOC(sizeof(int32_t) * (size_t)numPixels * 4);
 
+    GifPaletteCache* tempCache = NULL;
+    if( !cache )
+    {
+        tempCache = (GifPaletteCache*)GIF_TEMP_MALLOC(sizeof(GifPaletteCache));
+        GifPaletteCacheInit(tempCache);
+        cache = tempCache;
+    }
+    GifPaletteCacheReset(cache);
+
     for( int ii=0; ii<numPixels*4; ++ii )
     {
         uint8_t pix = nextFrame[ii];
@@ -446,11 +582,8 @@ void GifDitherImage( const uint8_t* lastFrame, const uint8_t* nextFrame, uint8_t
                 continue;
             }
 
-            int32_t bestDiff = 1000000;
-            int32_t bestInd = kGifTransIndex;
-
             // Search the palete
-            GifGetClosestPaletteColor(pPal, rr, gg, bb, &bestInd, &bestDiff, 1);
+            int32_t bestInd = GifLookupPaletteColor(pPal, cache, rr, gg, bb);
 
             // Write the result to the temp buffer
             int32_t r_err = nextPix[0] - (int32_t)(pPal->r[bestInd]) * 256;
@@ -509,12 +642,24 @@ void GifDitherImage( const uint8_t* lastFrame, const uint8_t* nextFrame, uint8_t
         outFrame[ii] = (uint8_t)quantPixels[ii];
     }
 
+    if( tempCache )
+        GIF_TEMP_FREE(tempCache);
     GIF_TEMP_FREE(quantPixels);
 }
 
-// Picks palette colors for the image using simple thresholding, no dithering
-void GifThresholdImage( const uint8_t* lastFrame, const uint8_t* nextFrame, uint8_t* outFrame, uint32_t width, uint32_t height, GifPalette* pPal )
+// Picks palette colors for the image using simple thresholding, no dithering.
+// cache may be NULL to use a temporary one.
+void GifThresholdImage( const uint8_t* lastFrame, const uint8_t* nextFrame, uint8_t* outFrame, uint32_t width, uint32_t height, GifPalette* pPal, GifPaletteCache* cache )
 {
+    GifPaletteCache* tempCache = NULL;
+    if( !cache )
+    {
+        tempCache = (GifPaletteCache*)GIF_TEMP_MALLOC(sizeof(GifPaletteCache));
+        GifPaletteCacheInit(tempCache);
+        cache = tempCache;
+    }
+    GifPaletteCacheReset(cache);
+
     uint32_t numPixels = width*height;
     for( uint32_t ii=0; ii<numPixels; ++ii )
     {
@@ -533,9 +678,7 @@ void GifThresholdImage( const uint8_t* lastFrame, const uint8_t* nextFrame, uint
         else
         {
             // palettize the pixel
-            int32_t bestDiff = 1000000;
-            int32_t bestInd = 1;
-            GifGetClosestPaletteColor(pPal, nextFrame[0], nextFrame[1], nextFrame[2], &bestInd, &bestDiff, 1);
+            int32_t bestInd = GifLookupPaletteColor(pPal, cache, nextFrame[0], nextFrame[1], nextFrame[2]);
 
             // Write the resulting color to the output buffer
             outFrame[0] = pPal->r[bestInd];
@@ -548,6 +691,9 @@ void GifThresholdImage( const uint8_t* lastFrame, const uint8_t* nextFrame, uint
         outFrame += 4;
         nextFrame += 4;
     }
+
+    if( tempCache )
+        GIF_TEMP_FREE(tempCache);
 }
 
 // Simple structure to write out the LZW-compressed portion of the image
@@ -582,17 +728,17 @@ void GifWriteBit( GifBitStatus* stat, uint32_t bit )
 }
 
 // write all bytes so far to the file
-void GifWriteChunk( FILE* f, GifBitStatus* stat )
+void GifWriteChunk( GifBuffer* out, GifBitStatus* stat )
 {
-    fputc((int)stat->chunkIndex, f);
-    fwrite(stat->chunk, 1, stat->chunkIndex, f);
+    GifBufferPut(out, (uint8_t)stat->chunkIndex);
+    GifBufferWrite(out, stat->chunk, stat->chunkIndex);
 
     stat->bitIndex = 0;
     stat->byte = 0;
     stat->chunkIndex = 0;
 }
 
-void GifWriteCode( FILE* f, GifBitStatus* stat, uint32_t code, uint32_t length )
+void GifWriteCode( GifBuffer* out, GifBitStatus* stat, uint32_t code, uint32_t length )
 {
     for( uint32_t ii=0; ii<length; ++ii )
     {
@@ -601,24 +747,68 @@ void GifWriteCode( FILE* f, GifBitStatus* stat, uint32_t code, uint32_t length )
 
         if( stat->chunkIndex == 255 )
         {
-            GifWriteChunk(f, stat);
+            GifWriteChunk(out, stat);
         }
     }
 }
 
-// The LZW dictionary is a 256-ary tree constructed as the file is encoded,
-// this is one node
+// The LZW dictionary maps (current code, next index) to the code for the extended run.
+// It is kept in an open-addressing hash table: at most 4096 codes are ever live, so
+// 8192 slots keep probe chains short while the whole table stays small enough to sit
+// in cache. Resetting only clears the slots that were filled since the last reset.
+#define GIF_LZW_HASH_BITS 13
+#define GIF_LZW_HASH_SIZE (1 << GIF_LZW_HASH_BITS)
+#define GIF_LZW_EMPTY 0xffffffffu
+
 typedef struct
 {
-    uint16_t m_next[256];
-} GifLzwNode;
+    uint32_t key[GIF_LZW_HASH_SIZE];   // (code << 8) | next index
+    uint16_t code[GIF_LZW_HASH_SIZE];
+    uint16_t used[4096];               // slots filled since the last reset
+    uint32_t numUsed;
+} GifLzwDict;
 
-// write a 256-color (8-bit) image palette to the file
-void GifWritePalette( const GifPalette* pPal, FILE* f )
+void GifLzwDictInit( GifLzwDict* dict )
 {
-    fputc(0, f);  // first color: transparency
-    fputc(0, f);
-    fputc(0, f);
+    memset(dict->key, 0xff, sizeof(dict->key));
+    dict->numUsed = 0;
+}
+
+void GifLzwDictReset( GifLzwDict* dict )
+{
+    for(uint32_t ii=0; ii<dict->numUsed; ++ii)
+        dict->key[dict->used[ii]] = GIF_LZW_EMPTY;
+    dict->numUsed = 0;
+}
+
+// Returns the code for the run, or 0 if it isn't in the dictionary yet (codes 0..clearCode+1
+// are never handed out for runs). In that case *slot is where the run should be inserted.
+uint32_t GifLzwDictFind( const GifLzwDict* dict, uint32_t key, uint32_t* slot )
+{
+    uint32_t ii = (key * 2654435761u) >> (32 - GIF_LZW_HASH_BITS);
+    while( dict->key[ii] != GIF_LZW_EMPTY )
+    {
+        if( dict->key[ii] == key )
+            return dict->code[ii];
+        ii = (ii + 1) & (GIF_LZW_HASH_SIZE - 1);
+    }
+    *slot = ii;
+    return 0;
+}
+
+void GifLzwDictInsert( GifLzwDict* dict, uint32_t slot, uint32_t key, uint32_t code )
+{
+    dict->key[slot] = key;
+    dict->code[slot] = (uint16_t)code;
+    dict->used[dict->numUsed++] = (uint16_t)slot;
+}
+
+// write a 256-color (8-bit) image palette to the output buffer
+void GifWritePalette( const GifPalette* pPal, GifBuffer* out )
+{
+    GifBufferPut(out, 0);  // first color: transparency
+    GifBufferPut(out, 0);
+    GifBufferPut(out, 0);
 
     for(int ii=1; ii<(1 << pPal->bitDepth); ++ii)
     {
@@ -626,51 +816,58 @@ void GifWritePalette( const GifPalette* pPal, FILE* f )
         uint32_t g = pPal->g[ii];
         uint32_t b = pPal->b[ii];
 
-        fputc((int)r, f);
-        fputc((int)g, f);
-        fputc((int)b, f);
+        GifBufferPut(out, (uint8_t)r);
+        GifBufferPut(out, (uint8_t)g);
+        GifBufferPut(out, (uint8_t)b);
     }
 }
 
 // write the image header, LZW-compress and write out the image
-void GifWriteLzwImage(FILE* f, uint8_t* image, uint32_t left, uint32_t top,  uint32_t width, uint32_t height, uint32_t delay, GifPalette* pPal)
+// dict may be NULL, in which case a temporary dictionary is allocated for this image
+void GifWriteLzwImage(GifBuffer* out, GifLzwDict* dict, uint8_t* image, uint32_t left, uint32_t top,  uint32_t width, uint32_t height, uint32_t delay, GifPalette* pPal)
 {
     // graphics control extension
-    fputc(0x21, f);
-    fputc(0xf9, f);
-    fputc(0x04, f);
-    fputc(0x05, f); // leave prev frame in place, this frame has transparency
-    fputc(delay & 0xff, f);
-    fputc((delay >> 8) & 0xff, f);
-    fputc(kGifTransIndex, f); // transparent color index
-    fputc(0, f);
-
-    fputc(0x2c, f); // image descriptor block
-
-    fputc(left & 0xff, f);           // corner of image in canvas space
-    fputc((left >> 8) & 0xff, f);
-    fputc(top & 0xff, f);
-    fputc((top >> 8) & 0xff, f);
-
-    fputc(width & 0xff, f);          // width and height of image
-    fputc((width >> 8) & 0xff, f);
-    fputc(height & 0xff, f);
-    fputc((height >> 8) & 0xff, f);
+    GifBufferPut(out, 0x21);
+    GifBufferPut(out, 0xf9);
+    GifBufferPut(out, 0x04);
+    GifBufferPut(out, 0x05); // leave prev frame in place, this frame has transparency
+    GifBufferPut(out, (uint8_t)(delay & 0xff));
+    GifBufferPut(out, (uint8_t)((delay >> 8) & 0xff));
+    GifBufferPut(out, (uint8_t)kGifTransIndex); // transparent color index
+    GifBufferPut(out, 0);
+
+    GifBufferPut(out, 0x2c); // image descriptor block
+
+    GifBufferPut(out, (uint8_t)(left & 0xff));           // corner of image in canvas space
+    GifBufferPut(out, (uint8_t)((left >> 8) & 0xff));
+    GifBufferPut(out, (uint8_t)(top & 0xff));
+    GifBufferPut(out, (uint8_t)((top >> 8) & 0xff));
+
+    GifBufferPut(out, (uint8_t)(width & 0xff));          // width and height of image
+    GifBufferPut(out, (uint8_t)((width >> 8) & 0xff));
+    GifBufferPut(out, (uint8_t)(height & 0xff));
+    GifBufferPut(out, (uint8_t)((height >> 8) & 0xff));
 
     //fputc(0, f); // no local color table, no transparency
     //fputc(0x80, f); // no local color table, but transparency
 
-    fputc(0x80 + pPal->bitDepth-1, f); // local color table present, 2 ^ bitDepth entries
-    GifWritePalette(pPal, f);
+    GifBufferPut(out, (uint8_t)(0x80 + pPal->bitDepth-1)); // local color table present, 2 ^ bitDepth entries
+    GifWritePalette(pPal, out);
 
     const int minCodeSize = pPal->bitDepth;
     const uint32_t clearCode = 1 << pPal->bitDepth;
 
-    fputc(minCodeSize, f); // min code size 8 bits
+    GifBufferPut(out, (uint8_t)minCodeSize); // min code size 8 bits
 
-    GifLzwNode* codetree = (GifLzwNode*)GIF_TEMP_MALLOC(sizeof(GifLzwNode)*4096);
+    GifLzwDict* tempDict = NULL;
+    if( !dict )
+    {
+        tempDict = (GifLzwDict*)GIF_TEMP_MALLOC(sizeof(GifLzwDict));
+        GifLzwDictInit(tempDict);
+        dict = tempDict;
+    }
+    GifLzwDictReset(dict);
 
-    memset(codetree, 0, sizeof(GifLzwNode)*4096);
     int32_t curCode = -1;
     uint32_t codeSize = (uint32_t)minCodeSize + 1;
     uint32_t maxCode = clearCode+1;
@@ -680,7 +877,7 @@ void GifWriteLzwImage(FILE* f, uint8_t* image, uint32_t left, uint32_t top,  uin
     stat.bitIndex = 0;
     stat.chunkIndex = 0;
 
-    GifWriteCode(f, &stat, clearCode, codeSize);  // start with a fresh LZW dictionary
+    GifWriteCode(out, &stat, clearCode, codeSize);  // start with a fresh LZW dictionary
 
     for(uint32_t yy=0; yy<height; ++yy)
     {
@@ -703,162 +900,406 @@ void GifWriteLzwImage(FILE* f, uint8_t* image, uint32_t left, uint32_t top,  uin
                 // first value in a new run
                 curCode = nextValue;
             }
-            else if( codetree[curCode].m_next[nextValue] )
-            {
-                // current run already in the dictionary
-                curCode = codetree[curCode].m_next[nextValue];
-            }
             else
             {
-                // finish the current run, write a code
-                GifWriteCode(f, &stat, (uint32_t)curCode, codeSize);
-
-                // insert the new run into the dictionary
-                codetree[curCode].m_next[nextValue] = (uint16_t)++maxCode;
+                uint32_t key = ((uint32_t)curCode << 8) | nextValue;
+                uint32_t slot = 0;
+                uint32_t nextCode = GifLzwDictFind(dict, key, &slot);
 
-                if( maxCode >= (1ul << codeSize) )
+                if( nextCode )
                 {
-                    // dictionary entry count has broken a size barrier,
-                    // we need more bits for codes
-                    codeSize++;
+                    // current run already in the dictionary
+                    curCode = (int32_t)nextCode;
                 }
-                if( maxCode == 4095 )
+                else
                 {
-                    // the dictionary is full, clear it out and begin anew
-                    GifWriteCode(f, &stat, clearCode, codeSize); // clear tree
-
-                    memset(codetree, 0, sizeof(GifLzwNode)*4096);
-                    codeSize = (uint32_t)(minCodeSize + 1);
-                    maxCode = clearCode+1;
+                    // finish the current run, write a code
+                    GifWriteCode(out, &stat, (uint32_t)curCode, codeSize);
+
+                    // insert the new run into the dictionary
+                    GifLzwDictInsert(dict, slot, key, ++maxCode);
+
+                    if( maxCode >= (1ul << codeSize) )
+                    {
+                        // dictionary entry count has broken a size barrier,
+                        // we need more bits for codes
+                        codeSize++;
+                    }
+                    if( maxCode == 4095 )
+                    {
+                        // the dictionary is full, clear it out and begin anew
+                        GifWriteCode(out, &stat, clearCode, codeSize); // clear tree
+
+                        GifLzwDictReset(dict);
+                        codeSize = (uint32_t)(minCodeSize + 1);
+                        maxCode = clearCode+1;
+                    }
+
+                    curCode = nextValue;
                 }
-
-                curCode = nextValue;
             }
         }
     }
 
     // compression footer
-    GifWriteCode(f, &stat, (uint32_t)curCode, codeSize);
-    GifWriteCode(f, &stat, clearCode, codeSize);
-    GifWriteCode(f, &stat, clearCode + 1, (uint32_t)minCodeSize + 1);
+    GifWriteCode(out, &stat, (uint32_t)curCode, codeSize);
+    GifWriteCode(out, &stat, clearCode, codeSize);
+    GifWriteCode(out, &stat, clearCode + 1, (uint32_t)minCodeSize + 1);
 
     // write out the last partial chunk
     while( stat.bitIndex ) GifWriteBit(&stat, 0);
-    if( stat.chunkIndex ) GifWriteChunk(f, &stat);
+    if( stat.chunkIndex ) GifWriteChunk(out, &stat);
 
-    fputc(0, f); // image block terminator
+    GifBufferPut(out, 0); // image block terminator
 
-    GIF_TEMP_FREE(codetree);
+    if( tempDict )
+        GIF_TEMP_FREE(tempDict);
+}
+
+// Palettizes a rectangle of a frame and appends its LZW-compressed image block to a buffer.
+// image holds just the rectangle's pixels (width*height RGBA) and left/top place it on the canvas.
+// lastFrame is what the viewer is showing underneath that rectangle (or NULL to replace it fully);
+// pixels that match it are written as transparent. outFrame receives the palettized RGBA result
+// (with the palette index in alpha) and may alias lastFrame.
+// This touches no shared state, so several frames can be encoded concurrently as long as
+// each one uses its own dict and palette cache (either may be NULL to use a temporary one).
+void GifEncodeFrameRect( const uint8_t* lastFrame, const uint8_t* image, uint8_t* outFrame, uint32_t left, uint32_t top, uint32_t width, uint32_t height, uint32_t delay, int bitDepth, bool dither, GifLzwDict* dict, GifPaletteCache* cache, GifBuffer* out )
+{
+    GifPalette pal;
+    GifMakePalette((dither? NULL : lastFrame), image, width, height, bitDepth, dither, &pal);
+
+    if(dither)
+        GifDitherImage(lastFrame, image, outFrame, width, height, &pal, cache);
+    else
+        GifThresholdImage(lastFrame, image, outFrame, width, height, &pal, cache);
+
+    GifWriteLzwImage(out, dict, outFrame, left, top, width, height, delay, &pal);
+}
+
+// Same as GifEncodeFrameRect for a frame covering the whole canvas
+void GifEncodeFrame( const uint8_t* lastFrame, const uint8_t* image, uint8_t* outFrame, uint32_t width, uint32_t height, uint32_t delay, int bitDepth, bool dither, GifLzwDict* dict, GifPaletteCache* cache, GifBuffer* out )
+{
+    GifEncodeFrameRect(lastFrame, image, outFrame, 0, 0, width, height, delay, bitDepth, dither, dict, cache, out);
 }
 
+// Where the finished GIF goes. Bytes are collected in a block buffer and handed to
+// write() in large pieces, so sinks never see per-byte traffic.
+// write() returns false on failure; the writer then stops producing output.
+typedef bool (*GifSinkWriteFn)( void* context, const uint8_t* data, size_t size );
+
+#define GIF_SINK_BLOCK_SIZE (64 * 1024)
+
 typedef struct
 {
-    FILE* f;
-    uint8_t* oldImage;
+    GifSinkWriteFn write;
+    void* context;
+    uint8_t* block;
+    size_t blockUsed;
+    bool failed;
+} GifSink;
+
+void GifSinkInit( GifSink* sink, GifSinkWriteFn write, void* context )
+{
+    sink->write = write;
+    sink->context = context;
+    sink->block = (uint8_t*)GIF_MALLOC(GIF_SINK_BLOCK_SIZE);
+    sink->blockUsed = 0;
+    sink->failed = false;
+}
+
+bool GifSinkFlush( GifSink* sink )
+{
+    if( sink->blockUsed && !sink->failed )
+        sink->failed = !sink->write(sink->context, sink->block, sink->blockUsed);
+    sink->blockUsed = 0;
+    return !sink->failed;
+}
+
+void GifSinkWrite( GifSink* sink, const void* data, size_t size )
+{
+    if( sink->blockUsed + size > GIF_SINK_BLOCK_SIZE )
+        GifSinkFlush(sink);
+
+    if( size >= GIF_SINK_BLOCK_SIZE )
+    {
+        // large pieces (whole encoded frames) go straight through
+        if( !sink->failed )
+            sink->failed = !sink->write(sink->context, (const uint8_t*)data, size);
+        return;
+    }
+
+    memcpy(sink->block + sink->blockUsed, data, size);
+    sink->blockUsed += size;
+}
+
+void GifSinkPut( GifSink* sink, uint8_t byte )
+{
+    if( sink->blockUsed == GIF_SINK_BLOCK_SIZE )
+        GifSinkFlush(sink);
+    sink->block[sink->blockUsed++] = byte;
+}
+
+void GifSinkFree( GifSink* sink )
+{
+    GIF_FREE(sink->block);
+    sink->block = NULL;
+    sink->blockUsed = 0;
+}
+
+// Ready-made sinks: context is a FILE*, a file descriptor cast to intptr_t, or a GifBuffer*
+bool GifFileSinkWrite( void* context, const uint8_t* data, size_t size )
+{
+    return fwrite(data, 1, size, (FILE*)context) == size;
+}
+
+bool GifFdSinkWrite( void* context, const uint8_t* data, size_t size )
+{
+    int fd = (int)(intptr_t)context;
+    while( size > 0 )
+    {
+#if defined(_WIN32)
+        int written = _write(fd, data, (unsigned int)(size > 0x40000000 ? 0x40000000 : size));
+#else
+        ssize_t written = write(fd, data, size);
+        if( written < 0 && errno == EINTR )
+            continue;
+#endif
+        if( written <= 0 )
+            return false;
+        data += written;
+        size -= (size_t)written;
+    }
+    return true;
+}
+
+bool GifBufferSinkWrite( void* context, const uint8_t* data, size_t size )
+{
+    GifBufferWrite((GifBuffer*)context, data, size);
+    return true;
+}
+
+typedef struct
+{
+    GifSink sink;
+    FILE* f;                // file opened by GifBegin and closed by GifEnd, NULL for caller-supplied sinks
+    uint8_t* oldImage;      // last palettized canvas, NULL when the writer keeps no previous-frame state
+    GifLzwDict* lzwDict;    // reused by every frame written through this writer
+    GifPaletteCache* paletteCache;
+    GifBuffer frameBuffer;
+    uint32_t width;
+    uint32_t height;
     bool firstFrame;
+    bool open;
 
-    uint8_t padding[7];    // make padding explicit
+    uint8_t padding[6];    // make padding explicit
 } GifWriter;
 
-// Creates a gif file.
+// Starts a GIF on any sink.
 // The input GIFWriter is assumed to be uninitialized.
 // The delay value is the time between frames in hundredths of a second - note that not all viewers pay much attention to this value.
-bool GifBegin( GifWriter* writer, const char* filename, uint32_t width, uint32_t height, uint32_t delay, int32_t bitDepth = 8, bool dither = false )
+// loopCount is how many times an animation repeats, 0 meaning forever.
+// Without keepPreviousFrame no canvas-sized copy is held; frames are then written without
+// delta encoding unless the caller sends only their dirty rectangles with GifWriteFrameRect
+// or pre-encoded frames with GifWriteEncodedFrame.
+// The header is flushed right away, so a sink that cannot be written to is reported here;
+// on failure everything is released and the writer is left closed.
+bool GifBeginSink( GifWriter* writer, GifSinkWriteFn write, void* context, uint32_t width, uint32_t height, uint32_t delay, uint16_t loopCount = 0, bool keepPreviousFrame = true )
 {
-    (void)bitDepth; (void)dither; // Mute "Unused argument" warnings
-#if defined(_MSC_VER) && (_MSC_VER >= 1400)
-	writer->f = 0;
-    fopen_s(&writer->f, filename, "wb");
-#else
-    writer->f = fopen(filename, "wb");
-#endif
-    if(!writer->f) return false;
-
+    GifSinkInit(&writer->sink, write, context);
+    writer->f = NULL;
+    writer->width = width;
+    writer->height = height;
     writer->firstFrame = true;
+    writer->open = true;
 
     // allocate
-    writer->oldImage = (uint8_t*)GIF_MALLOC(width*height*4);
+    writer->oldImage = NULL;
+    if( keepPreviousFrame )
+    {
+        writer->oldImage = (uint8_t*)GIF_MALLOC(width*height*4);
+        memset(writer->oldImage, 0, width*height*4);
+    }
+    writer->lzwDict = (GifLzwDict*)GIF_MALLOC(sizeof(GifLzwDict));
+    GifLzwDictInit(writer->lzwDict);
+    writer->paletteCache = (GifPaletteCache*)GIF_MALLOC(sizeof(GifPaletteCache));
+    GifPaletteCacheInit(writer->paletteCache);
+    GifBufferInit(&writer->frameBuffer);
 
-    fputs("GIF89a", writer->f);
+    GifSink* sink = &writer->sink;
+    GifSinkWrite(sink, "GIF89a", 6);
 
     // screen descriptor
-    fputc(width & 0xff, writer->f);
-    fputc((width >> 8) & 0xff, writer->f);
-    fputc(height & 0xff, writer->f);
-    fputc((height >> 8) & 0xff, writer->f);
+    GifSinkPut(sink, (uint8_t)(width & 0xff));
+    GifSinkPut(sink, (uint8_t)((width >> 8) & 0xff));
+    GifSinkPut(sink, (uint8_t)(height & 0xff));
+    GifSinkPut(sink, (uint8_t)((height >> 8) & 0xff));
 
-    fputc(0xf0, writer->f);  // there is an unsorted global color table of 2 entries
-    fputc(0, writer->f);     // background color
-    fputc(0, writer->f);     // pixels are square (we need to specify this because it's 1989)
+    GifSinkPut(sink, 0xf0);  // there is an unsorted global color table of 2 entries
+    GifSinkPut(sink, 0);     // background color
+    GifSinkPut(sink, 0);     // pixels are square (we need to specify this because it's 1989)
 
     // now the "global" palette (really just a dummy palette)
     // color 0: black
-    fputc(0, writer->f);
-    fputc(0, writer->f);
-    fputc(0, writer->f);
+    GifSinkPut(sink, 0);
+    GifSinkPut(sink, 0);
+    GifSinkPut(sink, 0);
     // color 1: also black
-    fputc(0, writer->f);
-    fputc(0, writer->f);
-    fputc(0, writer->f);
+    GifSinkPut(sink, 0);
+    GifSinkPut(sink, 0);
+    GifSinkPut(sink, 0);
 
     if( delay != 0 )
     {
         // animation header
-        fputc(0x21, writer->f); // extension
-        fputc(0xff, writer->f); // application specific
-        fputc(11, writer->f); // length 11
-        fputs("NETSCAPE2.0", writer->f); // yes, really
-        fputc(3, writer->f); // 3 bytes of NETSCAPE2.0 data
+        GifSinkPut(sink, 0x21); // extension
+        GifSinkPut(sink, 0xff); // application specific
+        GifSinkPut(sink, 11); // length 11
+        GifSinkWrite(sink, "NETSCAPE2.0", 11); // yes, really
+        GifSinkPut(sink, 3); // 3 bytes of NETSCAPE2.0 data
 
-        fputc(1, writer->f); // this is the Netscape 2.0 sub-block ID and it must be 1, otherwise some viewers error
-        fputc(0, writer->f); // loop infinitely (byte 0)
-        fputc(0, writer->f); // loop infinitely (byte 1)
+        GifSinkPut(sink, 1); // this is the Netscape 2.0 sub-block ID and it must be 1, otherwise some viewers error
+        GifSinkPut(sink, (uint8_t)(loopCount & 0xff)); // loop count, 0 = infinitely (byte 0)
+        GifSinkPut(sink, (uint8_t)((loopCount >> 8) & 0xff)); // loop count (byte 1)
 
-        fputc(0, writer->f); // block terminator
+        GifSinkPut(sink, 0); // block terminator
     }
 
+    if( !GifSinkFlush(sink) )
+    {
+        GifSinkFree(sink);
+        GIF_FREE(writer->oldImage);
+        GIF_FREE(writer->lzwDict);
+        GIF_FREE(writer->paletteCache);
+        GifBufferFree(&writer->frameBuffer);
+        writer->oldImage = NULL;
+        writer->lzwDict = NULL;
+        writer->paletteCache = NULL;
+        writer->open = false;
+        return false;
+    }
     return true;
 }
 
+// Creates a gif file.
+// The input GIFWriter is assumed to be uninitialized.
+bool GifBegin( GifWriter* writer, const char* filename, uint32_t width, uint32_t height, uint32_t delay, int32_t bitDepth = 8, bool dither = false, uint16_t loopCount = 0 )
+{
+    (void)bitDepth; (void)dither; // Mute "Unused argument" warnings
+    FILE* f = NULL;
+#if defined(_MSC_VER) && (_MSC_VER >= 1400)
+    fopen_s(&f, filename, "wb");
+#else
+    f = fopen(filename, "wb");
+#endif
+    if(!f)
+    {
+        writer->open = false;
+        return false;
+    }
+
+    if( !GifBeginSink(writer, GifFileSinkWrite, f, width, height, delay, loopCount, true) )
+    {
+        fclose(f);
+        return false;
+    }
+    writer->f = f;
+    return true;
+}
+
+// Writes out a new sub-rectangle of the canvas to a GIF in progress.
+// image holds width*height RGBA pixels that are placed at left/top.
+// If the writer keeps previous-frame state, unchanged pixels inside the rectangle are still
+// delta-encoded against it; otherwise the rectangle simply replaces what was there.
+bool GifWriteFrameRect( GifWriter* writer, const uint8_t* image, uint32_t left, uint32_t top, uint32_t width, uint32_t height, uint32_t delay, int bitDepth = 8, bool dither = false )
+{
+    if(!writer->open) return false;
+    if(left + width > writer->width || top + height > writer->height) return false;
+
+    bool useDelta = writer->oldImage && !writer->firstFrame;
+    writer->firstFrame = false;
+
+    // rectangle-local copy of the previous canvas, palettized in place
+    uint8_t* rectFrame = (uint8_t*)GIF_TEMP_MALLOC((size_t)width*height*4);
+    if( writer->oldImage )
+    {
+        for(uint32_t yy=0; yy<height; ++yy)
+            memcpy(rectFrame + (size_t)yy*width*4, writer->oldImage + ((size_t)(top+yy)*writer->width + left)*4, (size_t)width*4);
+    }
+
+    writer->frameBuffer.size = 0;
+    GifEncodeFrameRect(useDelta? rectFrame : NULL, image, rectFrame, left, top, width, height, delay, bitDepth, dither, writer->lzwDict, writer->paletteCache, &writer->frameBuffer);
+    GifSinkWrite(&writer->sink, writer->frameBuffer.data, writer->frameBuffer.size);
+
+    if( writer->oldImage )
+    {
+        for(uint32_t yy=0; yy<height; ++yy)
+            memcpy(writer->oldImage + ((size_t)(top+yy)*writer->width + left)*4, rectFrame + (size_t)yy*width*4, (size_t)width*4);
+    }
+
+    GIF_TEMP_FREE(rectFrame);
+    return !writer->sink.failed;
+}
+
 // Writes out a new frame to a GIF in progress.
 // The GIFWriter should have been created by GIFBegin.
 // AFAIK, it is legal to use different bit depths for different frames of an image -
 // this may be handy to save bits in animations that don't change much.
 bool GifWriteFrame( GifWriter* writer, const uint8_t* image, uint32_t width, uint32_t height, uint32_t delay, int bitDepth = 8, bool dither = false )
 {
-    if(!writer->f) return false;
+    if(!writer->open) return false;
+
+    if( !writer->oldImage )
+        return GifWriteFrameRect(writer, image, 0, 0, width, height, delay, bitDepth, dither);
 
     const uint8_t* oldImage = writer->firstFrame? NULL : writer->oldImage;
     writer->firstFrame = false;
 
-    GifPalette pal;
-    GifMakePalette((dither? NULL : oldImage), image, width, height, bitDepth, dither, &pal);
+    writer->frameBuffer.size = 0;
+    GifEncodeFrame(oldImage, image, writer->oldImage, width, height, delay, bitDepth, dither, writer->lzwDict, writer->paletteCache, &writer->frameBuffer);
+    GifSinkWrite(&writer->sink, writer->frameBuffer.data, writer->frameBuffer.size);
 
-    if(dither)
-        GifDitherImage(oldImage, image, writer->oldImage, width, height, &pal);
-    else
-        GifThresholdImage(oldImage, image, writer->oldImage, width, height, &pal);
+    return !writer->sink.failed;
+}
 
-    GifWriteLzwImage(writer->f, writer->oldImage, 0, 0, width, height, delay, &pal);
+// Appends a frame that was already encoded with GifEncodeFrame or GifEncodeFrameRect.
+// The writer's own delta state is not updated, so a GIF should be built either
+// entirely from GifWriteFrame calls or entirely from pre-encoded frames.
+bool GifWriteEncodedFrame( GifWriter* writer, const GifBuffer* frame )
+{
+    if(!writer->open) return false;
 
-    return true;
+    writer->firstFrame = false;
+    GifSinkWrite(&writer->sink, frame->data, frame->size);
+
+    return !writer->sink.failed;
 }
 
-// Writes the EOF code, closes the file handle, and frees temp memory used by a GIF.
+// Writes the EOF code, flushes the sink, closes the file handle if GifBegin opened one,
+// and frees temp memory used by a GIF. Returns false if any write failed.
 // Many if not most viewers will still display a GIF properly if the EOF code is missing,
 // but it's still a good idea to write it out.
 bool GifEnd( GifWriter* writer )
 {
-    if(!writer->f) return false;
+    if(!writer->open) return false;
 
-    fputc(0x3b, writer->f); // end of file
-    fclose(writer->f);
+    GifSinkPut(&writer->sink, 0x3b); // end of file
+    bool ok = GifSinkFlush(&writer->sink);
+    if( writer->f )
+        ok = (fclose(writer->f) == 0) && ok;
+
+    GifSinkFree(&writer->sink);
     GIF_FREE(writer->oldImage);
+    GIF_FREE(writer->lzwDict);
+    GIF_FREE(writer->paletteCache);
+    GifBufferFree(&writer->frameBuffer);
 
     writer->f = NULL;
     writer->oldImage = NULL;
+    writer->lzwDict = NULL;
+    writer->paletteCache = NULL;
+    writer->open = false;
 
-    return true;
+    return ok;
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,246 @@
+// File: main_bench.cpp
+// Benchmark: mengukur pembentukan Quadtree per metrik, rekonstruksi, penyimpanan per format,
+// dan pembuatan GIF pada korpus gambar sintetis yang deterministik.
+
+#include "Image.h"
+#include "QuadTree.h"
+#include "IOHandler.h"
+#include "MakeFrame.h"
+#include "MakeGif.h"
+#include "SyntheticImage.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+struct BenchOptions {
+    std::vector<int> sizes = {128, 512, 1024};
+    int repetitions = 5;
+    std::string filter;     // hanya kasus yang namanya mengandung teks ini
+    std::string csvPath;    // kosong = tanpa CSV
+    unsigned threads = 0;   // thread untuk kasus GIF
+};
+
+struct Summary {
+    double minMs = 0.0;
+    double medianMs = 0.0;
+    double meanMs = 0.0;
+    double stddevMs = 0.0;
+};
+
+Summary summarize(std::vector<double> samplesMs) {
+    Summary s;
+    std::sort(samplesMs.begin(), samplesMs.end());
+    const size_t n = samplesMs.size();
+    s.minMs = samplesMs.front();
+    s.medianMs = (n % 2) ? samplesMs[n / 2] : (samplesMs[n / 2 - 1] + samplesMs[n / 2]) / 2.0;
+    s.meanMs = std::accumulate(samplesMs.begin(), samplesMs.end(), 0.0) / static_cast<double>(n);
+    double variance = 0.0;
+    for (double v : samplesMs) {
+        variance += (v - s.meanMs) * (v - s.meanMs);
+    }
+    s.stddevMs = n > 1 ? std::sqrt(variance / static_cast<double>(n - 1)) : 0.0;
+    return s;
+}
+
+// Satu putaran pemanasan (cache, alokator, lazy init) lalu `repetitions` putaran terukur
+template <typename F>
+std::vector<double> timeRuns(int repetitions, F&& body) {
+    body();
+    std::vector<double> samples;
+    samples.reserve(repetitions);
+    for (int i = 0; i < repetitions; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        body();
+        samples.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+    return samples;
+}
+
+class Reporter {
+private:
+    std::ofstream csv;
+
+public:
+    explicit Reporter(const std::string& csvPath) {
+        std::cout << std::left << std::setw(22) << "case" << std::setw(10) << "pattern" << std::setw(7) << "size"
+                  << std::right << std::setw(10) << "min ms" << std::setw(10) << "median" << std::setw(10) << "mean"
+                  << std::setw(9) << "stddev" << std::setw(10) << "ns/px" << std::setw(12) << "nodes/s" << "\n";
+        if (!csvPath.empty()) {
+            csv.open(csvPath);
+            if (!csv) {
+                throw std::runtime_error("Gagal membuka file CSV: " + csvPath);
+            }
+            csv << "case,pattern,width,height,repetitions,min_ms,median_ms,mean_ms,stddev_ms,ns_per_pixel,nodes,nodes_per_s\n";
+        }
+    }
+
+    void add(const std::string& name, const std::string& pattern, int size, int repetitions,
+             const std::vector<double>& samplesMs, size_t nodes) {
+        Summary s = summarize(samplesMs);
+        const double pixels = static_cast<double>(size) * size;
+        const double nsPerPixel = s.medianMs * 1e6 / pixels;
+        const double nodesPerSecond = (nodes > 0 && s.medianMs > 0.0) ? static_cast<double>(nodes) / (s.medianMs / 1000.0) : 0.0;
+
+        std::cout << std::left << std::setw(22) << name << std::setw(10) << pattern << std::setw(7) << size
+                  << std::right << std::fixed << std::setprecision(3)
+                  << std::setw(10) << s.minMs << std::setw(10) << s.medianMs << std::setw(10) << s.meanMs
+                  << std::setw(9) << s.stddevMs << std::setprecision(2) << std::setw(10) << nsPerPixel
+                  << std::setprecision(0) << std::setw(12) << nodesPerSecond << std::defaultfloat << std::endl;
+
+        if (csv) {
+            csv << name << "," << pattern << "," << size << "," << size << "," << repetitions << ","
+                << s.minMs << "," << s.medianMs << "," << s.meanMs << "," << s.stddevMs << ","
+                << nsPerPixel << "," << nodes << "," << nodesPerSecond << "\n";
+        }
+    }
+};
+
+// Threshold menengah per metrik agar pohon tidak trivial dan tidak penuh
+float benchThreshold(ErrorMetric metric) {
+    switch (metric) {
+        case ErrorMetric::VARIANCE: return 100.0f;
+        case ErrorMetric::MAD: return 8.0f;
+        case ErrorMetric::MAX_PIXEL_DIFFERENCE: return 40.0f;
+        case ErrorMetric::ENTROPY: return 2.0f;
+        case ErrorMetric::SSIM: return 0.05f;
+    }
+    return 0.0f;
+}
+
+std::vector<int> parseSizes(const std::string& text) {
+    std::vector<int> sizes;
+    std::stringstream in(text);
+    std::string item;
+    while (std::getline(in, item, ',')) {
+        int size = std::stoi(item);
+        if (size < 1) {
+            throw std::invalid_argument("Ukuran gambar harus >= 1: " + item);
+        }
+        sizes.push_back(size);
+    }
+    return sizes;
+}
+
+BenchOptions parseOptions(int argc, char* argv[]) {
+    BenchOptions options;
+    for (int i = 1; i < argc; ++i) {
+        std::string flag = argv[i];
+        auto next = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                throw std::invalid_argument("Opsi " + flag + " membutuhkan nilai.");
+            }
+            return argv[++i];
+        };
+        if (flag == "--sizes") {
+            options.sizes = parseSizes(next());
+        } else if (flag == "--reps") {
+            options.repetitions = std::max(1, std::stoi(next()));
+        } else if (flag == "--filter") {
+            options.filter = next();
+        } else if (flag == "--csv") {
+            options.csvPath = next();
+        } else if (flag == "--threads") {
+            options.threads = static_cast<unsigned>(std::max(0, std::stoi(next())));
+        } else if (flag == "--quick") {
+            options.sizes = {128, 256};
+            options.repetitions = 3;
+        } else if (flag == "-h" || flag == "--help") {
+            std::cout << "Penggunaan: " << argv[0] << " [--sizes 128,512,1024] [--reps 5] [--filter teks]"
+                      << " [--csv hasil.csv] [--threads n] [--quick]\n";
+            std::exit(0);
+        } else {
+            throw std::invalid_argument("Opsi tidak dikenal: " + flag);
+        }
+    }
+    return options;
+}
+
+bool selected(const BenchOptions& options, const std::string& name) {
+    return options.filter.empty() || name.find(options.filter) != std::string::npos;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    try {
+        BenchOptions options = parseOptions(argc, argv);
+        Reporter reporter(options.csvPath);
+
+        const std::vector<ErrorMetric> metrics = {
+            ErrorMetric::VARIANCE, ErrorMetric::MAD, ErrorMetric::MAX_PIXEL_DIFFERENCE,
+            ErrorMetric::ENTROPY, ErrorMetric::SSIM
+        };
+        const std::vector<std::string> formats = {".png", ".jpg", ".bmp"};
+        const fs::path scratchDir = fs::temp_directory_path() / "quadtree_bench";
+        fs::create_directories(scratchDir);
+
+        for (int size : options.sizes) {
+            for (SyntheticImage::Pattern pattern : SyntheticImage::allPatterns()) {
+                const std::string patternName = SyntheticImage::patternName(pattern);
+                const Image source = SyntheticImage::generate(pattern, size, size, 42);
+                const int reps = options.repetitions;
+
+                for (ErrorMetric metric : metrics) {
+                    const std::string name = "build/" + IOHandler::metricKey(metric);
+                    if (!selected(options, name)) {
+                        continue;
+                    }
+                    size_t nodes = 0;
+                    auto samples = timeRuns(reps, [&] {
+                        Quadtree tree(source, metric, benchThreshold(metric), 4);
+                        nodes = tree.getNodeCount();
+                    });
+                    reporter.add(name, patternName, size, reps, samples, nodes);
+                }
+
+                // Pohon acuan untuk kasus yang bergantung pada hasil kompresi
+                Quadtree tree(source, ErrorMetric::VARIANCE, benchThreshold(ErrorMetric::VARIANCE), 4);
+                const Image reconstructed = tree.reconstructImage();
+
+                if (selected(options, "reconstruct")) {
+                    auto samples = timeRuns(reps, [&] { tree.reconstructImage(); });
+                    reporter.add("reconstruct", patternName, size, reps, samples, tree.getNodeCount());
+                }
+
+                for (const std::string& ext : formats) {
+                    const std::string name = "save/" + ext.substr(1);
+                    if (!selected(options, name)) {
+                        continue;
+                    }
+                    const std::string path = (scratchDir / ("bench" + ext)).string();
+                    auto samples = timeRuns(reps, [&] { reconstructed.saveImage(path, 85); });
+                    reporter.add(name, patternName, size, reps, samples, 0);
+                }
+
+                if (selected(options, "gif")) {
+                    GifSchedule schedule = GifSchedule::fromTree(tree, ErrorMetric::VARIANCE,
+                                                                 benchThreshold(ErrorMetric::VARIANCE), 4);
+                    auto samples = timeRuns(reps, [&] {
+                        MakeGif::encode(source, &tree, schedule, options.threads);
+                    });
+                    reporter.add("gif", patternName, size, reps, samples, 0);
+                }
+            }
+        }
+
+        fs::remove_all(scratchDir);
+    } catch (const std::exception& e) {
+        std::cerr << "[ERROR] " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,316 @@
+// File: main_golden.cpp
+// Golden test: membangun Quadtree untuk setiap ErrorMetric pada korpus tetap (gambar di test/input
+// dan gambar sintetis), lalu membandingkan jumlah simpul, kedalaman, jumlah leaf, hash piksel hasil
+// rekonstruksi, dan PSNR dengan nilai acuan yang tersimpan di file golden.
+//
+// Penggunaan:
+//   golden_test --golden test/golden/quadtree_golden.txt --input-dir test/input [--update] [--strict]
+// --update menulis ulang file golden dari hasil saat ini (lakukan hanya jika perubahan hasil disengaja).
+
+#include "Image.h"
+#include "QuadTree.h"
+#include "IOHandler.h"
+#include "SyntheticImage.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+struct GoldenOptions {
+    std::string goldenPath;
+    std::string inputDir;
+    bool update = false;
+    bool strict = false; // tanpa toleransi: hash harus sama persis untuk semua metrik
+};
+
+struct GoldenRecord {
+    size_t nodes = 0;
+    int depth = 0;
+    size_t leaves = 0;
+    uint64_t hash = 0;
+    double psnr = 0.0;
+    double treePsnr = 0.0; // dari SSE leaf yang disimpan pohon; tidak ditulis ke file golden
+};
+
+struct CorpusImage {
+    std::string name;
+    Image image;
+};
+
+const std::vector<ErrorMetric> kMetrics = {
+    ErrorMetric::VARIANCE, ErrorMetric::MAD, ErrorMetric::MAX_PIXEL_DIFFERENCE,
+    ErrorMetric::ENTROPY, ErrorMetric::SSIM
+};
+
+// Threshold menengah per metrik agar pohon tidak trivial dan tidak penuh
+double goldenThreshold(ErrorMetric metric) {
+    switch (metric) {
+        case ErrorMetric::VARIANCE: return 100.0;
+        case ErrorMetric::MAD: return 8.0;
+        case ErrorMetric::MAX_PIXEL_DIFFERENCE: return 40.0;
+        case ErrorMetric::ENTROPY: return 2.0;
+        case ErrorMetric::SSIM: return 0.05;
+    }
+    return 0.0;
+}
+
+// MAX_PIXEL_DIFFERENCE murni aritmetika bilangan bulat sehingga hasilnya harus identik.
+// Metrik lain memakai penjumlahan double yang boleh diurutkan ulang (SIMD, paralel),
+// sehingga keputusan split di sekitar threshold dapat berubah sedikit.
+bool isExactMetric(ErrorMetric metric) {
+    return metric == ErrorMetric::MAX_PIXEL_DIFFERENCE;
+}
+
+// FNV-1a 64-bit atas dimensi dan seluruh byte piksel (urutan baris)
+uint64_t hashImage(const Image& img) {
+    uint64_t hash = 0xcbf29ce484222325ull;
+    auto mix = [&hash](unsigned char byte) {
+        hash ^= byte;
+        hash *= 0x100000001b3ull;
+    };
+    for (int value : {img.getWidth(), img.getHeight()}) {
+        for (int shift = 0; shift < 32; shift += 8) {
+            mix(static_cast<unsigned char>(value >> shift));
+        }
+    }
+    for (const Pixel& p : img.getPixelData()) {
+        mix(p.r);
+        mix(p.g);
+        mix(p.b);
+    }
+    return hash;
+}
+
+double computePsnr(const Image& a, const Image& b) {
+    const std::vector<Pixel>& pa = a.getPixelData();
+    const std::vector<Pixel>& pb = b.getPixelData();
+    double sumSq = 0.0;
+    for (size_t i = 0; i < pa.size(); ++i) {
+        const double dr = pa[i].r - pb[i].r;
+        const double dg = pa[i].g - pb[i].g;
+        const double db = pa[i].b - pb[i].b;
+        sumSq += dr * dr + dg * dg + db * db;
+    }
+    const double mse = sumSq / (3.0 * static_cast<double>(pa.size()));
+    if (mse == 0.0) {
+        return 99.0; // gambar identik; dibatasi agar tetap dapat ditulis ke file golden
+    }
+    return 10.0 * std::log10(255.0 * 255.0 / mse);
+}
+
+std::vector<CorpusImage> loadCorpus(const std::string& inputDir) {
+    std::vector<CorpusImage> corpus;
+
+    std::vector<fs::path> files;
+    for (const auto& entry : fs::directory_iterator(inputDir)) {
+        std::string ext = entry.path().extension().string();
+        std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+        if (entry.is_regular_file() && (ext == ".png" || ext == ".jpg" || ext == ".jpeg" || ext == ".bmp")) {
+            files.push_back(entry.path());
+        }
+    }
+    std::sort(files.begin(), files.end());
+    for (const fs::path& file : files) {
+        corpus.push_back({file.filename().string(), Image::loadFromFile(file.string())});
+    }
+
+    // Ukuran ganjil dan tidak persegi agar pembagian sisa pada buildRecursive ikut teruji
+    const std::vector<std::pair<int, int>> sizes = {{256, 256}, {173, 97}};
+    for (const auto& [w, h] : sizes) {
+        for (SyntheticImage::Pattern pattern : SyntheticImage::allPatterns()) {
+            corpus.push_back({"synthetic/" + SyntheticImage::patternName(pattern) + "-" +
+                                  std::to_string(w) + "x" + std::to_string(h),
+                              SyntheticImage::generate(pattern, w, h, 42)});
+        }
+    }
+    return corpus;
+}
+
+GoldenRecord measure(const Image& source, ErrorMetric metric) {
+    Quadtree tree(source, metric, goldenThreshold(metric), 4);
+    const Image reconstructed = tree.reconstructImage();
+
+    GoldenRecord record;
+    record.nodes = tree.getNodeCount();
+    record.depth = tree.getDepth();
+    record.leaves = tree.getLeafCount();
+    record.hash = hashImage(reconstructed);
+    record.psnr = computePsnr(source, reconstructed);
+    record.treePsnr = tree.getPSNR();
+    return record;
+}
+
+// Format baris: <gambar> <metrik> <simpul> <kedalaman> <leaf> <hash hex> <psnr>
+std::map<std::string, GoldenRecord> readGolden(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) {
+        throw std::runtime_error("Gagal membuka file golden: " + path + " (jalankan dengan --update untuk membuatnya)");
+    }
+    std::map<std::string, GoldenRecord> records;
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(in, line)) {
+        ++lineNumber;
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        std::istringstream fields(line);
+        std::string image, metric, hashHex;
+        GoldenRecord record;
+        if (!(fields >> image >> metric >> record.nodes >> record.depth >> record.leaves >> hashHex >> record.psnr)) {
+            throw std::runtime_error("Baris golden tidak valid (" + path + ":" + std::to_string(lineNumber) + ")");
+        }
+        record.hash = std::stoull(hashHex, nullptr, 16);
+        records[image + " " + metric] = record;
+    }
+    return records;
+}
+
+void writeGolden(const std::string& path, const std::vector<std::pair<std::string, GoldenRecord>>& results) {
+    std::ofstream out(path);
+    if (!out) {
+        throw std::runtime_error("Gagal menulis file golden: " + path);
+    }
+    out << "# Dibuat oleh golden_test --update. Jangan diedit manual.\n";
+    out << "# gambar metrik simpul kedalaman leaf hash psnr\n";
+    for (const auto& [key, record] : results) {
+        out << key << " " << record.nodes << " " << record.depth << " " << record.leaves << " "
+            << std::hex << std::setw(16) << std::setfill('0') << record.hash << std::dec << std::setfill(' ')
+            << " " << std::fixed << std::setprecision(4) << record.psnr << std::defaultfloat << "\n";
+    }
+}
+
+// Mengembalikan pesan kosong jika hasil cocok dengan acuan
+std::string compare(const GoldenRecord& expected, const GoldenRecord& actual, bool exact) {
+    std::ostringstream diff;
+    // PSNR dari SSE per leaf harus sama dengan PSNR gambar rekonstruksi
+    if (std::abs(actual.treePsnr - actual.psnr) > 1e-3) {
+        diff << "PSNR pohon " << actual.treePsnr << " != PSNR rekonstruksi " << actual.psnr << " dB";
+        return diff.str();
+    }
+    if (exact) {
+        if (actual.nodes != expected.nodes || actual.depth != expected.depth ||
+            actual.leaves != expected.leaves || actual.hash != expected.hash) {
+            diff << "simpul " << expected.nodes << "->" << actual.nodes
+                 << ", kedalaman " << expected.depth << "->" << actual.depth
+                 << ", leaf " << expected.leaves << "->" << actual.leaves
+                 << (actual.hash != expected.hash ? ", hash berbeda" : "");
+        }
+        return diff.str();
+    }
+
+    // Toleransi: beberapa keputusan split di sekitar threshold boleh berubah,
+    // tetapi kualitas rekonstruksi harus praktis sama
+    const double nodeTolerance = std::max(8.0, 0.005 * static_cast<double>(expected.nodes));
+    const double nodeDelta = std::abs(static_cast<double>(actual.nodes) - static_cast<double>(expected.nodes));
+    if (nodeDelta > nodeTolerance) {
+        diff << "simpul " << expected.nodes << "->" << actual.nodes << " (toleransi " << nodeTolerance << ")";
+    } else if (std::abs(actual.depth - expected.depth) > 1) {
+        diff << "kedalaman " << expected.depth << "->" << actual.depth;
+    } else if (std::abs(actual.psnr - expected.psnr) > 0.05) {
+        diff << "PSNR " << expected.psnr << "->" << actual.psnr << " dB";
+    }
+    return diff.str();
+}
+
+GoldenOptions parseOptions(int argc, char* argv[]) {
+    GoldenOptions options;
+    for (int i = 1; i < argc; ++i) {
+        std::string flag = argv[i];
+        auto next = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                throw std::invalid_argument("Opsi " + flag + " membutuhkan nilai.");
+            }
+            return argv[++i];
+        };
+        if (flag == "--golden") {
+            options.goldenPath = next();
+        } else if (flag == "--input-dir") {
+            options.inputDir = next();
+        } else if (flag == "--update") {
+            options.update = true;
+        } else if (flag == "--strict") {
+            options.strict = true;
+        } else if (flag == "-h" || flag == "--help") {
+            std::cout << "Penggunaan: " << argv[0] << " --golden file.txt --input-dir dir [--update] [--strict]\n";
+            std::exit(0);
+        } else {
+            throw std::invalid_argument("Opsi tidak dikenal: " + flag);
+        }
+    }
+    if (options.goldenPath.empty() || options.inputDir.empty()) {
+        throw std::invalid_argument("--golden dan --input-dir wajib diisi.");
+    }
+    return options;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    try {
+        GoldenOptions options = parseOptions(argc, argv);
+        const std::vector<CorpusImage> corpus = loadCorpus(options.inputDir);
+
+        std::vector<std::pair<std::string, GoldenRecord>> results;
+        for (const CorpusImage& item : corpus) {
+            for (ErrorMetric metric : kMetrics) {
+                results.emplace_back(item.name + " " + IOHandler::metricKey(metric), measure(item.image, metric));
+            }
+        }
+
+        if (options.update) {
+            writeGolden(options.goldenPath, results);
+            std::cout << "Golden diperbarui: " << results.size() << " kasus ditulis ke " << options.goldenPath << std::endl;
+            return 0;
+        }
+
+        std::map<std::string, GoldenRecord> golden = readGolden(options.goldenPath);
+        int passed = 0;
+        int failed = 0;
+        for (size_t i = 0; i < results.size(); ++i) {
+            const auto& [key, actual] = results[i];
+            const ErrorMetric metric = kMetrics[i % kMetrics.size()];
+            auto it = golden.find(key);
+            if (it == golden.end()) {
+                std::cout << "FAIL: " << key << ": tidak ada nilai acuan (jalankan --update)" << std::endl;
+                failed++;
+                continue;
+            }
+            std::string diff = compare(it->second, actual, options.strict || isExactMetric(metric));
+            if (diff.empty()) {
+                if (actual.hash != it->second.hash) {
+                    std::cout << "PASS: " << key << " (dalam toleransi, hash berbeda)" << std::endl;
+                }
+                passed++;
+            } else {
+                std::cout << "FAIL: " << key << ": " << diff << std::endl;
+                failed++;
+            }
+            golden.erase(it);
+        }
+        for (const auto& [key, record] : golden) {
+            std::cout << "FAIL: " << key << ": ada di file golden tetapi tidak ada di korpus" << std::endl;
+            failed++;
+        }
+
+        std::cout << "Golden test: " << passed << " lulus, " << failed << " gagal." << std::endl;
+        return failed > 0 ? 1 : 0;
+    } catch (const std::exception& e) {
+        std::cerr << "[ERROR] " << e.what() << std::endl;
+        return 2;
+    }
+}
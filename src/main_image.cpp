@@ -20,7 +20,7 @@ void printPixel(const std::string& label, int x, int y, const Pixel& p) {
               << ", B=" << static_cast<int>(p.b) << std::endl;
 }
 
-int main() {
+int main(int argc, char* argv[]) {
     std::cout << "Starting Image Class Test Driver..." << std::endl;
     int tests_passed = 0;
     int tests_failed = 0;
@@ -76,7 +76,8 @@ int main() {
     // --- Test Loading ---
     printTestHeader("Image Loading");
     Image testImg; // Gunakan objek ini untuk tes berikutnya
-    const std::string inputFilename = "xiao.png"; // !!! PENTING: Anda harus menyediakan file ini !!!
+    // Path gambar uji dapat diberikan sebagai argumen pertama (dipakai oleh ctest)
+    const std::string inputFilename = argc > 1 ? argv[1] : "xiao.png"; // !!! PENTING: Anda harus menyediakan file ini !!!
     bool loadSuccess = false;                      // Untuk skip tes berikutnya jika load gagal
 
     // Coba load file yang valid (gunakan factory method)
@@ -87,11 +88,9 @@ int main() {
             loadSuccess = true;
 
             // Mencetak seluruh data piksel dari gambar
-            const std::vector<Pixel>& pixelData = testImg.getPixelData(); // Mengambil data piksel
-
             for (int y = 0; y < testImg.getHeight(); ++y) {
                 for (int x = 0; x < testImg.getWidth(); ++x) {
-                    Pixel p = testImg.getPixel(x, y);  // Mendapatkan piksel pada koordinat (x, y)
+                    Pixel p = testImg.getPixel(y, x);  // Mendapatkan piksel pada koordinat (x, y); getPixel(baris, kolom)
                     std::cout << "Pixel (" << x << "," << y << "): "
                             << "R=" << static_cast<int>(p.r) << ", "
                             << "G=" << static_cast<int>(p.g) << ", "
@@ -146,7 +145,7 @@ int main() {
 
             // Test getPixel (out of bounds X)
             try {
-                testImg.getPixel(testImg.getWidth(), 0); // X = width (invalid)
+                testImg.getPixel(0, testImg.getWidth()); // X = width (invalid); getPixel(baris, kolom)
                 std::cout << "FAIL: getPixel with invalid X did not throw std::out_of_range." << std::endl; tests_failed++;
             } catch (const std::out_of_range& e) {
                  std::cout << "PASS: Caught expected std::out_of_range for getPixel(X OOB): " << e.what() << std::endl; tests_passed++;
@@ -154,7 +153,7 @@ int main() {
 
             // Test getPixel (out of bounds Y)
             try {
-                testImg.getPixel(0, testImg.getHeight()); // Y = height (invalid)
+                testImg.getPixel(testImg.getHeight(), 0); // Y = height (invalid)
                 std::cout << "FAIL: getPixel with invalid Y did not throw std::out_of_range." << std::endl; tests_failed++;
             } catch (const std::out_of_range& e) {
                  std::cout << "PASS: Caught expected std::out_of_range for getPixel(Y OOB): " << e.what() << std::endl; tests_passed++;
@@ -163,7 +162,7 @@ int main() {
 
              // Test setPixel (out of bounds X)
             try {
-                testImg.setPixel(-1, 0, {0,0,0}); // X negatif
+                testImg.setPixel(0, -1, {0,0,0}); // X negatif
                 std::cout << "FAIL: setPixel with invalid X did not throw std::out_of_range." << std::endl; tests_failed++;
             } catch (const std::out_of_range& e) {
                  std::cout << "PASS: Caught expected std::out_of_range for setPixel(X OOB): " << e.what() << std::endl; tests_passed++;
@@ -171,7 +170,7 @@ int main() {
 
             // Test setPixel (out of bounds Y)
             try {
-                testImg.setPixel(0, testImg.getHeight(), {0,0,0}); // Y = height
+                testImg.setPixel(testImg.getHeight(), 0, {0,0,0}); // Y = height
                 std::cout << "FAIL: setPixel with invalid Y did not throw std::out_of_range." << std::endl; tests_failed++;
             } catch (const std::out_of_range& e) {
                  std::cout << "PASS: Caught expected std::out_of_range for setPixel(Y OOB): " << e.what() << std::endl; tests_passed++;
@@ -195,7 +194,7 @@ int main() {
         std::cout << "PASS: fill called without throwing." << std::endl; tests_passed++;
 
         // Verifikasi fill dengan getPixel
-        Pixel checkPixel = fillImg.getPixel(fillImg.getWidth() / 2, fillImg.getHeight() / 2); // Ambil piksel tengah
+        Pixel checkPixel = fillImg.getPixel(fillImg.getHeight() / 2, fillImg.getWidth() / 2); // Ambil piksel tengah
         if (checkPixel.r == fillColor.r && checkPixel.g == fillColor.g && checkPixel.b == fillColor.b) {
              std::cout << "PASS: fill seems to work correctly (checked center pixel)." << std::endl; tests_passed++;
         } else {
@@ -0,0 +1,804 @@
+// File: main_unit.cpp
+// Unit test komponen yang tidak tercakup golden test: model ukuran, pencarian threshold,
+// sweep, penggabungan leaf, dan model leaf. Setiap bagian mencetak PASS/FAIL per kasus.
+//
+// Penggunaan:
+//   unit_test --input-dir test/input
+//   unit_test --input-dir test/input --fit-size-model   (mencetak ulang koefisien SizeEstimator)
+
+#include "Compressor.h"
+#include "Image.h"
+#include "QuadTree.h"
+#include "RegionMerge.h"
+#include "IOHandler.h"
+#include "MakeGif.h"
+#include "SizeEstimator.h"
+#include "SyntheticImage.h"
+#include "ThresholdSearch.h"
+#include "ThresholdSweep.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+int testsPassed = 0;
+int testsFailed = 0;
+
+void printTestHeader(const std::string& testName) {
+    std::cout << "\n--- Testing: " << testName << " ---" << std::endl;
+}
+
+void check(bool condition, const std::string& name, const std::string& detail = "") {
+    if (condition) {
+        testsPassed++;
+        std::cout << "PASS: " << name << std::endl;
+    } else {
+        testsFailed++;
+        std::cout << "FAIL: " << name << (detail.empty() ? "" : ": " + detail) << std::endl;
+    }
+}
+
+struct CorpusImage {
+    std::string name;
+    Image image;
+};
+
+std::vector<CorpusImage> loadCorpus(const std::string& inputDir) {
+    std::vector<CorpusImage> corpus;
+    std::vector<fs::path> files;
+    for (const auto& entry : fs::directory_iterator(inputDir)) {
+        const std::string ext = IOHandler::toLower(entry.path().extension().string());
+        if (entry.is_regular_file() && (ext == ".png" || ext == ".jpg" || ext == ".jpeg")) {
+            files.push_back(entry.path());
+        }
+    }
+    std::sort(files.begin(), files.end());
+    for (const fs::path& file : files) {
+        corpus.push_back({file.filename().string(), Image::loadFromFile(file.string())});
+    }
+    for (SyntheticImage::Pattern pattern : SyntheticImage::allPatterns()) {
+        corpus.push_back({"synthetic/" + SyntheticImage::patternName(pattern) + "_256x256",
+                          SyntheticImage::generate(pattern, 256, 256, 42)});
+        corpus.push_back({"synthetic/" + SyntheticImage::patternName(pattern) + "_173x97",
+                          SyntheticImage::generate(pattern, 173, 97, 42)});
+    }
+    return corpus;
+}
+
+struct SizeSample {
+    std::string name;
+    double threshold;
+    TreeSizeFeatures features;
+    size_t leaves;
+    Quadtree tree;
+};
+
+// Pohon yang dipakai untuk fit dan uji SizeEstimator: setiap gambar korpus pada beberapa
+// threshold variance, dari pohon hampir penuh sampai beberapa leaf
+std::vector<SizeSample> buildSizeSamples(const std::vector<CorpusImage>& corpus) {
+    const std::vector<double> thresholds = {5.0, 20.0, 50.0, 200.0, 800.0, 2000.0};
+    std::vector<SizeSample> samples;
+    for (const CorpusImage& item : corpus) {
+        for (double threshold : thresholds) {
+            Quadtree tree(item.image, ErrorMetric::VARIANCE, threshold, 1);
+            TreeSizeFeatures features = TreeSizeFeatures::fromTree(tree);
+            samples.push_back({item.name, threshold, features, tree.getLeafCount(), std::move(tree)});
+        }
+    }
+    return samples;
+}
+
+// Kuadrat terkecil untuk error relatif: minimalkan sum ((x . c - y) / y)^2 lewat persamaan
+// normal (eliminasi Gauss dengan pivot parsial; jumlah koefisien kecil)
+std::vector<double> fitRelative(const std::vector<std::vector<double>>& rows, const std::vector<double>& actual) {
+    const size_t n = rows.front().size();
+    std::vector<std::vector<double>> m(n, std::vector<double>(n + 1, 0.0));
+    for (size_t k = 0; k < rows.size(); ++k) {
+        for (size_t i = 0; i < n; ++i) {
+            const double xi = rows[k][i] / actual[k];
+            for (size_t j = 0; j < n; ++j) {
+                m[i][j] += xi * rows[k][j] / actual[k];
+            }
+            m[i][n] += xi;
+        }
+    }
+    for (size_t i = 0; i < n; ++i) {
+        size_t pivot = i;
+        for (size_t r = i + 1; r < n; ++r) {
+            if (std::abs(m[r][i]) > std::abs(m[pivot][i])) {
+                pivot = r;
+            }
+        }
+        std::swap(m[i], m[pivot]);
+        for (size_t r = 0; r < n; ++r) {
+            if (r != i && m[i][i] != 0.0) {
+                const double factor = m[r][i] / m[i][i];
+                for (size_t j = i; j <= n; ++j) {
+                    m[r][j] -= factor * m[i][j];
+                }
+            }
+        }
+    }
+    std::vector<double> coefficients(n);
+    for (size_t i = 0; i < n; ++i) {
+        coefficients[i] = m[i][i] != 0.0 ? m[i][n] / m[i][i] : 0.0;
+    }
+    return coefficients;
+}
+
+// Mengulang fit koefisien PNG dan JPG (kualitas 85) di SizeEstimator.cpp dari korpus
+void fitSizeModel(const std::vector<SizeSample>& samples) {
+    struct Model {
+        std::string extension;
+        std::vector<std::string> names;
+        std::vector<double> (*features)(const TreeSizeFeatures&);
+    };
+    const std::vector<Model> models = {
+        {".png", {"konstanta", "piksel", "rowRuns", "perimeter", "log2AreaSum", "distinctColors", "edgeContrast"},
+         [](const TreeSizeFeatures& f) {
+             return std::vector<double>{1.0, static_cast<double>(f.width) * f.height, f.rowRuns, f.perimeter,
+                                        f.log2AreaSum, static_cast<double>(f.distinctColors), f.edgeContrast};
+         }},
+        {".jpg", {"konstanta", "edgeContrast", "smallLeafArea"},
+         [](const TreeSizeFeatures& f) { return std::vector<double>{1.0, f.edgeContrast, f.smallLeafArea}; }},
+    };
+    for (const Model& model : models) {
+        std::vector<std::vector<double>> rows;
+        std::vector<double> actual;
+        for (const SizeSample& sample : samples) {
+            rows.push_back(model.features(sample.features));
+            actual.push_back(static_cast<double>(
+                sample.tree.reconstructImage().encodeToMemory(model.extension, 85).size()));
+        }
+        const std::vector<double> coefficients = fitRelative(rows, actual);
+        std::cout << model.extension << ":";
+        for (size_t i = 0; i < coefficients.size(); ++i) {
+            std::cout << " " << model.names[i] << "=" << coefficients[i];
+        }
+        std::cout << std::endl;
+    }
+}
+
+// Perkiraan SizeEstimator tanpa kalibrasi dibandingkan dengan encode sebenarnya. Rasio
+// perkiraan/aktual dicetak per kasus. Batas PNG dan JPG adalah error fit pada korpus ini
+// (PNG 0.56..1.55, JPG 0.57..1.60) ditambah sedikit kelonggaran, sehingga koefisien yang tidak
+// lagi cocok dengan encoder atau fitur langsung ketahuan. TGA hanya perkiraan awal kasar: batas
+// atas (toleransi paket RLE yang terpotong 128 piksel) yang bisa beberapa kali lipat pada area
+// rata terpecah banyak leaf, sehingga yang diuji hanya sisi bawah dan kasus terburuk korpus.
+// BMP harus tepat.
+void testSizeEstimator(const std::vector<SizeSample>& samples) {
+    printTestHeader("SizeEstimator vs encode sebenarnya");
+    struct FormatBound {
+        std::string extension;
+        double minRatio;   // perkiraan/aktual terkecil yang diterima
+        double maxRatio;   // perkiraan/aktual terbesar yang diterima
+        double maxMeanLog; // |rata-rata log2(perkiraan/aktual)| atas semua kasus format ini
+    };
+    const std::vector<FormatBound> formats = {{".png", 0.53, 1.65, 0.15},
+                                              {".jpg", 0.55, 1.65, 0.1},
+                                              {".bmp", 0.999, 1.001, 0.001},
+                                              {".tga", 0.95, 7.5, 0.75}};
+
+    for (const FormatBound& format : formats) {
+        SizeEstimator estimator(format.extension, 85);
+        double minRatio = std::numeric_limits<double>::infinity();
+        double maxRatio = 0.0;
+        double logSum = 0.0;
+        for (const SizeSample& sample : samples) {
+            const double estimated = estimator.estimate(sample.features);
+            const double actual = static_cast<double>(
+                sample.tree.reconstructImage().encodeToMemory(format.extension, 85).size());
+            const double ratio = estimated / actual;
+            std::cout << "  " << format.extension << " " << sample.name << " t=" << sample.threshold << ": "
+                      << sample.leaves << " leaf, perkiraan " << static_cast<long long>(estimated)
+                      << ", aktual " << static_cast<long long>(actual) << ", rasio " << ratio << std::endl;
+            minRatio = std::min(minRatio, ratio);
+            maxRatio = std::max(maxRatio, ratio);
+            logSum += std::log2(ratio);
+        }
+        const double meanLog = logSum / static_cast<double>(samples.size());
+        std::ostringstream detail;
+        detail << "rasio " << minRatio << ".." << maxRatio << ", rata-rata log2 rasio " << meanLog;
+        check(minRatio >= format.minRatio && maxRatio <= format.maxRatio && std::abs(meanLog) <= format.maxMeanLog,
+              "SizeEstimator " + format.extension + " (" + detail.str() + ")");
+    }
+}
+
+struct SearchRun {
+    int probes = 0;
+    bool converged = false;
+    bool batchesValid = true; // setiap batch terurut, unik, dan belum pernah dicoba
+    std::optional<ThresholdSearch::Sample> best;
+};
+
+// Menjalankan ThresholdSearch seperti Compressor::searchThresholdForTarget, tetapi ukuran
+// diambil dari fungsi sintetis. Berhenti saat konvergen atau setelah maxProbes percobaan.
+SearchRun runSearch(double low, double high, double target, double tolerance,
+                    const std::function<double(double)>& bytesAt, size_t batchSize, int maxProbes) {
+    ThresholdSearch search(low, high, target, tolerance);
+    SearchRun run;
+    while (run.probes < maxProbes && !search.converged()) {
+        const std::vector<double> thresholds = search.nextBatch(batchSize);
+        if (thresholds.empty()) {
+            break;
+        }
+        for (size_t i = 0; i < thresholds.size(); ++i) {
+            if ((i > 0 && thresholds[i] <= thresholds[i - 1]) || search.lookup(thresholds[i]) ||
+                thresholds[i] < low || thresholds[i] > high) {
+                run.batchesValid = false;
+            }
+        }
+        run.batchesValid = run.batchesValid && thresholds.size() <= batchSize;
+        for (double threshold : thresholds) {
+            search.record({threshold, 0, bytesAt(threshold)});
+            run.probes++;
+        }
+    }
+    run.converged = search.converged();
+    run.best = search.best();
+    return run;
+}
+
+std::string describe(const SearchRun& run) {
+    std::ostringstream out;
+    out << run.probes << " percobaan";
+    if (run.best) {
+        out << ", terbaik t=" << run.best->threshold << " (" << run.best->bytes << " bytes)";
+    }
+    return out.str();
+}
+
+void testThresholdSearch() {
+    printTestHeader("ThresholdSearch dengan fungsi ukuran sintetis");
+    // Ukuran turun mulus seperti kurva threshold sungguhan (kira-kira pangkat terhadap threshold)
+    auto smooth = [](double t) { return 1.0e6 / std::pow(1.0 + t, 1.5); };
+
+    // Konvergensi: target di tengah kurva tercapai dalam toleransi 1% dengan sedikit percobaan
+    for (size_t batch : {static_cast<size_t>(1), static_cast<size_t>(4)}) {
+        const SearchRun run = runSearch(0.0, 1000.0, 20000.0, 200.0, smooth, batch, 40);
+        check(run.converged && run.best && std::abs(run.best->bytes - 20000.0) <= 200.0 &&
+                  run.probes <= (batch == 1 ? 12 : 20) && run.batchesValid,
+              "Konvergen ke target (batch " + std::to_string(batch) + ", " + describe(run) + ")");
+    }
+
+    // Batas percobaan: jika dihentikan sebelum konvergen (seperti maxIterations di Compressor),
+    // best() tetap mengembalikan sampel terdekat yang sudah dicoba
+    {
+        const SearchRun run = runSearch(0.0, 1000.0, 20000.0, 0.0, smooth, 1, 4);
+        check(!run.converged && run.probes == 4 && run.best && std::abs(run.best->bytes - 20000.0) <= 2000.0,
+              "Dihentikan batas percobaan: hasil terbaik sejauh ini dipakai (" + describe(run) + ")");
+    }
+
+    // Target di dalam loncatan ukuran (tidak ada threshold yang tepat): rentang menyempit
+    // ke titik loncatan sampai konvergen dengan sendirinya, sebelum batas 40 percobaan
+    {
+        auto step = [](double t) { return t < 100.0 ? 45000.0 : 10000.0; };
+        const SearchRun run = runSearch(0.0, 1000.0, 30000.0, 100.0, step, 1, 100);
+        check(run.converged && run.probes <= 40 && run.best && run.best->threshold < 100.0 &&
+                  run.best->threshold > 99.0,
+              "Target di loncatan: bracket menyempit ke titik loncatan (" + describe(run) + ")");
+    }
+
+    // Target tidak tercapai: ujung rentang dicoba lalu pencarian berhenti di pohon terkecil
+    {
+        const SearchRun run = runSearch(0.0, 1000.0, 10.0, 1.0, smooth, 1, 100);
+        check(run.converged && run.probes <= 40 && run.best && run.best->threshold == 1000.0,
+              "Target di bawah ukuran terkecil memilih threshold maksimum (" + describe(run) + ")");
+    }
+
+    // Plateau: ukuran tidak berubah di rentang lebar tepat di atas target. Secant tidak punya
+    // kemiringan di plateau, jadi bisection harus mengambil alih (Illinois/stale)
+    {
+        auto plateau = [](double t) { return t < 10.0 ? 80000.0 : (t < 500.0 ? 21000.0 : 5000.0); };
+        const SearchRun run = runSearch(0.0, 1000.0, 20000.0, 100.0, plateau, 1, 100);
+        check(run.converged && run.probes <= 40 && run.best && run.best->bytes == 21000.0,
+              "Plateau: konvergen dan memilih sisi plateau terdekat (" + describe(run) + ")");
+    }
+
+    // Tidak monoton: riak +-3% di atas kurva mulus (penggabungan leaf dan encoder tidak
+    // menjamin monoton). Pencarian tetap berhenti dan hasilnya tetap dekat target.
+    {
+        auto bumpy = [&smooth](double t) { return smooth(t) * (1.0 + 0.03 * std::sin(t * 0.7)); };
+        const SearchRun run = runSearch(0.0, 1000.0, 20000.0, 100.0, bumpy, 1, 100);
+        check(run.converged && run.probes <= 40 && run.best && std::abs(run.best->bytes - 20000.0) <= 1000.0,
+              "Tidak monoton: berhenti dekat target (" + describe(run) + ")");
+    }
+}
+
+// Setiap titik sweep mewakili pohon DEPTH_FIRST untuk semua threshold di [thresholdLow,
+// thresholdHigh); beberapa titik patah dibandingkan dengan pohon yang dibangun ulang dari nol
+// pada threshold tersebut (jumlah simpul/leaf, PSNR, fitur ukuran, dan piksel rekonstruksi).
+void testSweepMatchesFreshBuild(const std::vector<CorpusImage>& corpus) {
+    printTestHeader("ThresholdSweep vs pohon baru");
+    QuadtreeOptions options;
+    options.mergeTolerance = -1;
+    for (const CorpusImage& item : corpus) {
+        if (item.name.find("_256x256") != std::string::npos || item.name == "suisei.jpg") {
+            continue; // cukup gambar kecil; pola yang sama sudah ada dalam ukuran 173x97
+        }
+        for (ErrorMetric metric : {ErrorMetric::VARIANCE, ErrorMetric::MAD, ErrorMetric::ENTROPY}) {
+            const ThresholdSweep sweep(item.image, metric, 2, options);
+            const std::vector<SweepPoint>& points = sweep.getPoints();
+            const size_t pixelCount = static_cast<size_t>(item.image.getWidth()) * item.image.getHeight();
+            int mismatches = 0;
+            std::string firstMismatch;
+            for (size_t k = 0; k < 5; ++k) {
+                const SweepPoint& point = points[k * (points.size() - 1) / 4];
+                // Titik tengah hanya jika masih di dalam rentang; error simpul yang secara
+                // matematis sama bisa berbeda satu ulp sehingga rentangnya sangat sempit
+                std::vector<double> thresholds = {point.thresholdLow};
+                const double middle = (point.thresholdLow + point.thresholdHigh) / 2.0;
+                if (std::isfinite(point.thresholdHigh) && middle < point.thresholdHigh) {
+                    thresholds.push_back(middle);
+                }
+                for (double threshold : thresholds) {
+                    const Quadtree fresh(item.image, metric, threshold, 2, options);
+                    const TreeSizeFeatures features = TreeSizeFeatures::fromTree(fresh);
+                    const double psnr = Quadtree::psnrFromSquaredError(fresh.getSquaredError(), pixelCount);
+                    const bool same = fresh.getNodeCount() == point.nodes && fresh.getLeafCount() == point.leaves &&
+                                      fresh.getDepth() == point.depth && std::abs(psnr - point.psnr) <= 1e-6 &&
+                                      features.distinctColors == point.features.distinctColors &&
+                                      std::abs(features.edgeContrast - point.features.edgeContrast) <= 1e-6 &&
+                                      std::abs(features.smallLeafArea - point.features.smallLeafArea) <= 1e-6 &&
+                                      fresh.reconstructImage().encodeToMemory(".bmp") ==
+                                          sweep.reconstructImage(threshold).encodeToMemory(".bmp");
+                    if (!same && mismatches++ == 0) {
+                        std::ostringstream detail;
+                        detail << "t=" << threshold << ": sweep " << point.leaves << " leaf, PSNR " << point.psnr
+                               << "; baru " << fresh.getLeafCount() << " leaf, PSNR " << psnr;
+                        firstMismatch = detail.str();
+                    }
+                }
+            }
+            check(mismatches == 0, "Sweep = pohon baru: " + item.name + " " + IOHandler::metricKey(metric) + " (" +
+                                       std::to_string(points.size()) + " titik)",
+                  firstMismatch);
+        }
+    }
+}
+
+int maxChannelDeviation(const Image& a, const Image& b) {
+    const std::vector<Pixel>& pa = a.getPixelData();
+    const std::vector<Pixel>& pb = b.getPixelData();
+    int deviation = 0;
+    for (size_t i = 0; i < pa.size(); ++i) {
+        deviation = std::max({deviation, std::abs(pa[i].r - pb[i].r), std::abs(pa[i].g - pb[i].g),
+                              std::abs(pa[i].b - pb[i].b)});
+    }
+    return deviation;
+}
+
+// Setiap piksel keluaran --merge siblings/regions boleh bergeser paling banyak tolerance per
+// channel dari pohon yang sama tanpa penggabungan, berapa pun dalamnya penggabungan berantai
+void testMergeDeviation(const std::vector<CorpusImage>& corpus) {
+    printTestHeader("Batas selisih warna penggabungan leaf");
+    for (const CorpusImage& item : corpus) {
+        if (item.name.find("_256x256") != std::string::npos || item.name == "suisei.jpg") {
+            continue;
+        }
+        for (int tolerance : {0, 4, 16, 40}) {
+            QuadtreeOptions options;
+            const Quadtree unmerged(item.image, ErrorMetric::VARIANCE, 20.0, 1, options);
+            const Image reference = unmerged.reconstructImage();
+            options.mergeTolerance = tolerance;
+            const Quadtree merged(item.image, ErrorMetric::VARIANCE, 20.0, 1, options);
+            const std::vector<LeafRegion> regions = RegionMerge::fromTree(merged, tolerance);
+            const Image regionImage = RegionMerge::reconstruct(item.image.getWidth(), item.image.getHeight(), regions);
+
+            const int siblingsDeviation = maxChannelDeviation(merged.reconstructImage(), reference);
+            const int regionsDeviation = maxChannelDeviation(regionImage, reference);
+            std::ostringstream detail;
+            detail << item.name << " toleransi " << tolerance << ": " << unmerged.getLeafCount() << " -> "
+                   << merged.getLeafCount() << " leaf -> " << regions.size() << " wilayah, selisih maks "
+                   << siblingsDeviation << " / " << regionsDeviation;
+            check(siblingsDeviation <= tolerance && regionsDeviation <= tolerance, "Penggabungan " + detail.str());
+        }
+    }
+}
+
+// --min-psnr dengan --merge: PSNR yang dilaporkan berasal dari gambar output gabungan, dan
+// qualityFloorMet harus sesuai dengan PSNR tersebut
+void testQualityFloorWithMerge(const std::vector<CorpusImage>& corpus) {
+    printTestHeader("Target kualitas dengan penggabungan leaf");
+    IOHandler io;
+    io.setQuiet(true);
+    const Compressor compressor(io);
+    const double floor = 30.0;
+    for (const CorpusImage& item : corpus) {
+        if (item.name != "Shock.png" && item.name.find("_173x97") == std::string::npos) {
+            continue;
+        }
+        for (MergeMode mergeMode : {MergeMode::SIBLINGS, MergeMode::REGIONS}) {
+            for (int tolerance : {8, 16, 40}) {
+                CompressionOptions options;
+                options.minPsnr = floor;
+                options.mergeMode = mergeMode;
+                options.mergeTolerance = tolerance;
+                CompressionResult result;
+                std::vector<unsigned char> encoded;
+                compressor.compressToMemory(item.image, options, ".png", encoded, result);
+
+                std::ostringstream detail;
+                detail << item.name << (mergeMode == MergeMode::SIBLINGS ? " siblings" : " regions") << " toleransi "
+                       << tolerance << ": PSNR " << result.psnr << " dB, " << result.leafCount << " leaf, floor "
+                       << (result.qualityFloorMet ? "tercapai" : "tidak tercapai");
+                const bool reached = result.psnr >= floor - 1e-9;
+                // Toleransi kecil tidak boleh membuat batas tidak tercapai; toleransi besar bisa
+                // (gradien halus yang digabung menjadi warna rata), asalkan dilaporkan
+                const bool expected = tolerance <= 8 ? reached && result.qualityFloorMet
+                                                     : reached == result.qualityFloorMet;
+                check(expected, "PSNR --min-psnr " + detail.str());
+            }
+        }
+    }
+}
+
+// Garis horizontal selebar pita rows: pembagian empat memecah setiap pita sepanjang lebar
+// gambar, pembagian adaptif cukup memotong tinggi
+Image makeStripes(int width, int height, int rows) {
+    Image image(width, height);
+    std::vector<Pixel>& pixels = image.getPixelData();
+    for (int y = 0; y < height; ++y) {
+        const int band = y / rows;
+        const Pixel color(static_cast<unsigned char>((band * 53) % 256), static_cast<unsigned char>(255 - (band * 31) % 256),
+                          static_cast<unsigned char>((90 + band * 17) % 256));
+        std::fill_n(pixels.begin() + static_cast<size_t>(y) * width, width, color);
+    }
+    return image;
+}
+
+void testAdaptiveSplit() {
+    printTestHeader("Pembagian adaptif vs empat pada gambar bergaris");
+    for (int rows : {8, 12}) {
+        const Image stripes = makeStripes(192, 96, rows);
+        QuadtreeOptions adaptiveOptions;
+        adaptiveOptions.splitMode = SplitMode::ADAPTIVE;
+
+        // Threshold sama: adaptif mencapai error yang tidak lebih besar dengan leaf lebih sedikit
+        const Quadtree quad(stripes, ErrorMetric::VARIANCE, 1.0, 1);
+        const Quadtree adaptive(stripes, ErrorMetric::VARIANCE, 1.0, 1, adaptiveOptions);
+        std::ostringstream detail;
+        detail << "pita " << rows << " baris: quad " << quad.getLeafCount() << " leaf SSE " << quad.getSquaredError()
+               << ", adaptif " << adaptive.getLeafCount() << " leaf SSE " << adaptive.getSquaredError();
+        check(adaptive.getLeafCount() * 2 < quad.getLeafCount() && adaptive.getSquaredError() <= quad.getSquaredError() + 1e-6,
+              "Threshold sama, " + detail.str());
+
+        // Jumlah leaf sama (best-first): adaptif memberi error lebih kecil
+        QuadtreeOptions quadBudget;
+        quadBudget.buildMode = BuildMode::BEST_FIRST;
+        quadBudget.maxLeaves = 16;
+        QuadtreeOptions adaptiveBudget = quadBudget;
+        adaptiveBudget.splitMode = SplitMode::ADAPTIVE;
+        const Quadtree quadLimited(stripes, ErrorMetric::VARIANCE, 0.0, 1, quadBudget);
+        const Quadtree adaptiveLimited(stripes, ErrorMetric::VARIANCE, 0.0, 1, adaptiveBudget);
+        std::ostringstream limitedDetail;
+        limitedDetail << "pita " << rows << " baris, maks 16 leaf: quad " << quadLimited.getLeafCount() << " leaf SSE "
+                      << quadLimited.getSquaredError() << ", adaptif " << adaptiveLimited.getLeafCount() << " leaf SSE "
+                      << adaptiveLimited.getSquaredError();
+        check(adaptiveLimited.getLeafCount() <= 16 && adaptiveLimited.getSquaredError() < quadLimited.getSquaredError(),
+              "Leaf sama, " + limitedDetail.str());
+    }
+}
+
+// BEST_FIRST dengan batas leaf: setiap split empat pada gambar 2^k menambah tepat 3 leaf,
+// sehingga batas 1 + 3k tercapai persis selama pohon penuh lebih besar. Pohon dengan batas
+// lebih kecil adalah awalan pohon yang lebih besar, jadi SSE tidak boleh naik saat batas naik.
+void testBestFirstLeafLimit(const std::vector<CorpusImage>& corpus) {
+    printTestHeader("BEST_FIRST dengan --max-leaves");
+    for (const CorpusImage& item : corpus) {
+        if (item.name.find("_256x256") == std::string::npos) {
+            continue;
+        }
+        QuadtreeOptions options;
+        options.buildMode = BuildMode::BEST_FIRST;
+        const size_t fullLeaves = Quadtree(item.image, ErrorMetric::VARIANCE, 0.0, 1, options).getLeafCount();
+        double previousError = std::numeric_limits<double>::infinity();
+        bool exact = true;
+        bool monotone = true;
+        std::ostringstream detail;
+        detail << item.name << " (pohon penuh " << fullLeaves << " leaf):";
+        for (size_t limit : {1, 4, 97, 1000, 4000, 16000}) {
+            options.maxLeaves = limit;
+            const Quadtree tree(item.image, ErrorMetric::VARIANCE, 0.0, 1, options);
+            const double error = tree.getSquaredError();
+            detail << " " << limit << "->" << tree.getLeafCount() << " SSE " << error << ";";
+            exact = exact && tree.getLeafCount() == std::min(limit, fullLeaves);
+            monotone = monotone && error <= previousError;
+            previousError = error;
+        }
+        check(exact, "Jumlah leaf sama dengan batas " + item.name, detail.str());
+        check(monotone, "SSE tidak naik saat batas leaf naik " + item.name, detail.str());
+    }
+}
+
+// RATE_DISTORTION: lambda lebih besar memangkas lebih banyak, jadi rate tidak naik dan SSE
+// tidak turun saat lambda naik. Target rate memilih pemangkasan paling sedikit yang muat.
+void testRateDistortion(const std::vector<CorpusImage>& corpus) {
+    printTestHeader("Pemangkasan RATE_DISTORTION");
+    for (const CorpusImage& item : corpus) {
+        if (item.name.find("_173x97") == std::string::npos) {
+            continue;
+        }
+        QuadtreeOptions options;
+        options.buildMode = BuildMode::RATE_DISTORTION;
+        double previousRate = std::numeric_limits<double>::infinity();
+        double previousError = -1.0;
+        bool monotone = true;
+        std::ostringstream detail;
+        detail << item.name << ":";
+        for (double lambda : {0.5, 5.0, 50.0, 500.0, 5000.0}) {
+            options.lambda = lambda;
+            const Quadtree tree(item.image, ErrorMetric::VARIANCE, 0.0, 1, options);
+            detail << " lambda " << lambda << " rate " << tree.getRateBits() << " SSE " << tree.getSquaredError() << ";";
+            monotone = monotone && tree.getRateBits() <= previousRate && tree.getSquaredError() >= previousError;
+            previousRate = tree.getRateBits();
+            previousError = tree.getSquaredError();
+        }
+        check(monotone, "Rate tidak naik dan SSE tidak turun saat lambda naik", detail.str());
+
+        // Target rate: hasil tidak melebihi target dan tidak jauh di bawahnya
+        options.lambda = 0.0;
+        const double fullRate = Quadtree(item.image, ErrorMetric::VARIANCE, 0.0, 1, options).getRateBits();
+        for (double fraction : {0.1, 0.3, 0.6}) {
+            options.targetRateBits = fullRate * fraction;
+            const Quadtree tree(item.image, ErrorMetric::VARIANCE, 0.0, 1, options);
+            std::ostringstream rateDetail;
+            rateDetail << item.name << " target " << options.targetRateBits << " bit: rate " << tree.getRateBits();
+            check(tree.getRateBits() <= options.targetRateBits && tree.getRateBits() >= 0.9 * options.targetRateBits,
+                  "Target rate RD " + rateDetail.str());
+        }
+        options.targetRateBits = 0.0;
+    }
+
+    // Mode target RD lewat Compressor: ukuran encode sebenarnya dalam toleransi 5% target.
+    // Gradien tidak dipakai: PNG sumbernya sudah hampir seukuran gambar satu warna (deflate stb
+    // memakai Huffman tetap), sehingga target di bawahnya tidak mungkin dicapai.
+    IOHandler io;
+    io.setQuiet(true);
+    const Compressor compressor(io);
+    for (SyntheticImage::Pattern pattern : {SyntheticImage::Pattern::NOISE, SyntheticImage::Pattern::TEXT_EDGES}) {
+        const Image image = SyntheticImage::generate(pattern, 256, 256, 42);
+        for (float ratio : {0.5f, 0.8f}) {
+            CompressionOptions options;
+            options.buildMode = BuildMode::RATE_DISTORTION;
+            options.targetCompressionRatio = ratio;
+            CompressionResult result;
+            result.inputBytes = image.encodeToMemory(".png", 85).size();
+            std::vector<unsigned char> encoded;
+            compressor.compressToMemory(image, options, ".png", encoded, result);
+            const double target = static_cast<double>(result.inputBytes) * (1.0 - ratio);
+            std::ostringstream detail;
+            detail << SyntheticImage::patternName(pattern) << " rasio " << ratio << ": " << result.outputBytes
+                   << " bytes, target " << static_cast<long long>(target) << ", " << result.searchIterations << " iterasi";
+            check(std::abs(static_cast<double>(result.outputBytes) - target) <= 0.05 * target,
+                  "Target ukuran RD " + detail.str());
+        }
+    }
+}
+
+// Batas memori pohon: pohon yang tidak muat dibangun ulang dengan blok minimum lebih besar
+// sampai simpulnya muat (tabel RegionStats tidak dibatasi, jadi diuji dengan QUAD/FLAT)
+void testMemoryBudget(const std::vector<CorpusImage>& corpus) {
+    printTestHeader("Batas memori pohon");
+    for (const CorpusImage& item : corpus) {
+        if (item.name != "Shock.png" && item.name.find("noise_256x256") == std::string::npos) {
+            continue;
+        }
+        const Quadtree unlimited(item.image, ErrorMetric::VARIANCE, 0.0, 1);
+        for (size_t divisor : {4, 64}) {
+            QuadtreeOptions options;
+            options.memoryBudgetBytes = unlimited.getMemoryUsage() / divisor;
+            const Quadtree limited(item.image, ErrorMetric::VARIANCE, 0.0, 1, options);
+            std::ostringstream detail;
+            detail << item.name << " anggaran " << options.memoryBudgetBytes << " byte: " << limited.getMemoryUsage()
+                   << " byte, blok minimum " << limited.getEffectiveMinBlockSize() << ", " << limited.getLeafCount()
+                   << " leaf (tanpa batas " << unlimited.getLeafCount() << ")";
+            check(limited.getMemoryUsage() <= options.memoryBudgetBytes && limited.getEffectiveMinBlockSize() > 1 &&
+                      limited.isBudgetLimited(),
+                  "Pohon muat di anggaran " + detail.str());
+        }
+
+        // Anggaran yang cukup tidak mengubah pohon
+        QuadtreeOptions roomy;
+        roomy.memoryBudgetBytes = unlimited.getMemoryUsage();
+        const Quadtree fits(item.image, ErrorMetric::VARIANCE, 0.0, 1, roomy);
+        check(fits.getEffectiveMinBlockSize() == 1 && fits.getLeafCount() == unlimited.getLeafCount(),
+              "Anggaran cukup tidak mengubah pohon " + item.name);
+    }
+}
+
+// Jumlah frame dan ukuran layar GIF dari struktur bloknya (header, tabel warna global,
+// ekstensi, deskriptor gambar). Mengembalikan -1 jika struktur rusak.
+int countGifFrames(const std::vector<uint8_t>& gif, int& width, int& height) {
+    if (gif.size() < 13 || std::string(gif.begin(), gif.begin() + 6) != "GIF89a") {
+        return -1;
+    }
+    width = gif[6] | (gif[7] << 8);
+    height = gif[8] | (gif[9] << 8);
+    size_t pos = 13;
+    if (gif[10] & 0x80) {
+        pos += 3u << ((gif[10] & 0x07) + 1);
+    }
+    auto skipSubBlocks = [&gif](size_t& at) {
+        while (at < gif.size() && gif[at] != 0) {
+            at += gif[at] + 1u;
+        }
+        ++at;
+        return at <= gif.size();
+    };
+    int frames = 0;
+    while (pos < gif.size()) {
+        const uint8_t introducer = gif[pos];
+        if (introducer == 0x3B) {
+            return pos + 1 == gif.size() ? frames : -1;
+        }
+        if (introducer == 0x21 && pos + 2 < gif.size()) {
+            pos += 2;
+        } else if (introducer == 0x2C && pos + 10 < gif.size()) {
+            const uint8_t packed = gif[pos + 9];
+            pos += 10;
+            if (packed & 0x80) {
+                pos += 3u << ((packed & 0x07) + 1);
+            }
+            ++pos; // ukuran kode minimum LZW
+            ++frames;
+        } else {
+            return -1;
+        }
+        if (!skipSubBlocks(pos)) {
+            return -1;
+        }
+    }
+    return -1;
+}
+
+// GIF paralel: hasil 1 thread dan beberapa thread harus identik byte per byte, sink yang
+// menerima potongan harus menyusun byte yang sama, dan jumlah frame mengikuti jadwal
+void testGifStream(const std::vector<CorpusImage>& corpus) {
+    printTestHeader("GIF paralel dan streaming");
+    for (const CorpusImage& item : corpus) {
+        if (item.name != "Shock.png" && item.name.find("text_173x97") == std::string::npos) {
+            continue;
+        }
+        const Quadtree tree(item.image, ErrorMetric::VARIANCE, 50.0, 1);
+        GifSchedule depthSchedule = GifSchedule::fromTree(tree, ErrorMetric::VARIANCE, 50.0f, 1);
+        GifSchedule rampSchedule;
+        rampSchedule.threshold = 50.0f;
+        rampSchedule.frameCount = 6;
+        for (const auto& [label, schedule, finalTree] :
+             {std::make_tuple("depth", depthSchedule, &tree), std::make_tuple("ramp", rampSchedule, static_cast<const Quadtree*>(nullptr))}) {
+            const std::vector<uint8_t> single = MakeGif::encode(item.image, finalTree, schedule, 1);
+            const std::vector<uint8_t> parallel = MakeGif::encode(item.image, finalTree, schedule, 4);
+            std::vector<uint8_t> streamed;
+            size_t chunks = 0;
+            const bool ok = MakeGif::stream(item.image, finalTree, schedule, [&](const uint8_t* data, size_t size) {
+                streamed.insert(streamed.end(), data, data + size);
+                ++chunks;
+                return true;
+            }, 3);
+            int width = 0;
+            int height = 0;
+            const int frames = countGifFrames(parallel, width, height);
+            std::ostringstream detail;
+            detail << item.name << " " << label << ": " << single.size() << " / " << parallel.size() << " / "
+                   << streamed.size() << " byte (" << chunks << " potongan), " << frames << " frame dari "
+                   << schedule.totalFrames() << ", " << width << "x" << height;
+            check(!single.empty() && single == parallel && ok && streamed == single,
+                  "Byte GIF 1 thread = 4 thread = stream " + detail.str());
+            check(frames == schedule.totalFrames() && width == item.image.getWidth() && height == item.image.getHeight(),
+                  "Jumlah frame dan ukuran GIF " + detail.str());
+        }
+    }
+}
+
+
+void testPlaneLeafModel(const std::vector<CorpusImage>& corpus) {
+    printTestHeader("Model leaf bidang (PLANE)");
+    // Ramp linear bilangan bulat: satu bidang per channel mewakilinya tanpa error
+    const int width = 48;
+    const int height = 32;
+    Image ramp(width, height);
+    std::vector<Pixel>& pixels = ramp.getPixelData();
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            pixels[static_cast<size_t>(y) * width + x] = Pixel(static_cast<unsigned char>(2 * x + 10),
+                                                               static_cast<unsigned char>(3 * y + 20),
+                                                               static_cast<unsigned char>(x + y));
+        }
+    }
+
+    QuadtreeOptions options;
+    options.leafModel = LeafModel::PLANE;
+    const Quadtree plane(ramp, ErrorMetric::VARIANCE, 0.5, 1, options);
+    const Quadtree flat(ramp, ErrorMetric::VARIANCE, 0.5, 1);
+    const int deviation = maxChannelDeviation(plane.reconstructImage(), ramp);
+    std::ostringstream detail;
+    detail << plane.getLeafCount() << " leaf (flat " << flat.getLeafCount() << "), SSE " << plane.getSquaredError()
+           << ", selisih maks " << deviation;
+    check(plane.getLeafCount() == 1 && plane.getSquaredError() < 1e-6 && deviation == 0,
+          "Ramp linear diwakili satu leaf bidang tanpa error", detail.str());
+    check(flat.getLeafCount() > 100, "Ramp linear butuh banyak leaf warna rata", detail.str());
+
+    // Rate RD leaf bidang menghitung gradien, bukan hanya warna rata-rata
+    for (const CorpusImage& item : corpus) {
+        if (item.name.find("_173x97") == std::string::npos) {
+            continue;
+        }
+        QuadtreeOptions rdOptions;
+        rdOptions.buildMode = BuildMode::RATE_DISTORTION;
+        rdOptions.leafModel = LeafModel::PLANE;
+        rdOptions.lambda = 50.0;
+        const Quadtree rd(item.image, ErrorMetric::VARIANCE, 0.0, 1, rdOptions);
+        const double leaves = static_cast<double>(rd.getLeafCount());
+        const double internal = static_cast<double>(rd.getNodeCount()) - leaves;
+        const double expected = leaves * (Quadtree::NodeFlagBits + Quadtree::LeafColorBits + Quadtree::LeafGradientBits) +
+                                internal * Quadtree::NodeFlagBits;
+        std::ostringstream rateDetail;
+        rateDetail << rd.getRateBits() << " bit, diharapkan " << expected;
+        check(std::abs(rd.getRateBits() - expected) < 1e-6, "Rate RD leaf bidang " + item.name, rateDetail.str());
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string inputDir;
+    bool fitOnly = false;
+    for (int i = 1; i < argc; ++i) {
+        const std::string flag = argv[i];
+        if (flag == "--input-dir" && i + 1 < argc) {
+            inputDir = argv[++i];
+        } else if (flag == "--fit-size-model") {
+            fitOnly = true;
+        } else {
+            inputDir.clear();
+            break;
+        }
+    }
+    if (inputDir.empty()) {
+        std::cerr << "Penggunaan: " << argv[0] << " --input-dir dir [--fit-size-model]" << std::endl;
+        return 2;
+    }
+
+    try {
+        const std::vector<CorpusImage> corpus = loadCorpus(inputDir);
+        const std::vector<SizeSample> sizeSamples = buildSizeSamples(corpus);
+        if (fitOnly) {
+            fitSizeModel(sizeSamples);
+            return 0;
+        }
+        testSizeEstimator(sizeSamples);
+        testThresholdSearch();
+        testSweepMatchesFreshBuild(corpus);
+        testMergeDeviation(corpus);
+        testQualityFloorWithMerge(corpus);
+        testAdaptiveSplit();
+        testBestFirstLeafLimit(corpus);
+        testRateDistortion(corpus);
+        testMemoryBudget(corpus);
+        testGifStream(corpus);
+        testPlaneLeafModel(corpus);
+    } catch (const std::exception& e) {
+        std::cout << "FAIL: Unexpected exception: " << e.what() << std::endl;
+        testsFailed++;
+    }
+
+    printTestHeader("Test Summary");
+    std::cout << "Tests Passed: " << testsPassed << std::endl;
+    std::cout << "Tests Failed: " << testsFailed << std::endl;
+    return testsFailed > 0 ? 1 : 0;
+}